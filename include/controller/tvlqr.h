@@ -11,7 +11,7 @@
 #include <drake/math/rotation_matrix.h>
 #include <drake/math/roll_pitch_yaw.h>
 
-#include "trajopt/MISOSProblem.h"
+#include "trajopt/SolvedTrajectory.h"
 
 namespace controller
 {
@@ -69,8 +69,7 @@ namespace controller
 
 			std::unique_ptr<DrakeControllerTVLQR> construct_drake_controller(
 					double dt,
-					trajopt::MISOSProblem* traj
-					// TODO more elegant way of passing this?
+					const trajopt::SolvedTrajectory& traj
 					);
 
 		private:
@@ -154,7 +153,9 @@ namespace controller
 					Eigen::Vector3d w_Dt
 					);
 
-			Eigen::VectorXd get_state_traj_from_flat_outputs(trajopt::MISOSProblem* traj_obj, double t);
+			Eigen::VectorXd get_state_traj_from_flat_outputs(
+					const trajopt::TrajectorySamples& flat_outputs, int s
+					);
 
 			drake::symbolic::Environment make_drake_env_state(Eigen::VectorXd state);
 
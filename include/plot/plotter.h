@@ -12,7 +12,7 @@ namespace plt = matplotlibcpp;
 typedef	std::unordered_map<std::string, std::string> string_map;
 
 void plot_traj(
-		trajopt::MISOSProblem *traj, int num_traj_segments, Eigen::VectorX<double> init_pos, Eigen::VectorX<double> final_pos
+		const trajopt::SolvedTrajectory& traj, Eigen::VectorX<double> init_pos, Eigen::VectorX<double> final_pos
 		);
 void plot_2d_obstacles(std::vector<Eigen::MatrixXd> obstacles);
 void plot_2d_region(std::vector<Eigen::VectorXd> points, bool filled);
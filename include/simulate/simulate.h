@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdlib>
 #include <iostream>
 
 #include <gflags/gflags.h>
@@ -23,6 +24,7 @@
 #include "tools/geometry.h"
 #include "trajopt/safe_regions.h"
 #include "trajopt/MISOSProblem.h"
+#include "trajopt/planner.h"
 #include "controller/tvlqr.h"
 #include "plot/plotter.h"
 #include "simulate/publish_trajectory.h"
@@ -46,12 +48,24 @@ class DrakeSimulation
 		void build_quadrotor_diagram();
 		void connect_to_drake_visualizer();
 		void retrieve_obstacles();
-		void add_controller_tvlqr(trajopt::MISOSProblem* traj);
+		void add_controller_tvlqr(const trajopt::SolvedTrajectory& traj);
 		void run_simulation(Eigen::VectorXd x0);
-		void calculate_safe_regions(int num_safe_regions);
+		void calculate_safe_regions(int num_safe_regions)
+		{
+			calculate_safe_regions(num_safe_regions, true);
+		};
+		void calculate_safe_regions(int num_safe_regions, bool plot)
+		{
+			calculate_safe_regions(num_safe_regions, plot, true);
+		};
+		void calculate_safe_regions(
+				int num_safe_regions, bool plot, bool remove_redundant_halfspaces
+				);
 
 		std::vector<Eigen::MatrixXd> get_safe_regions_As();
 		std::vector<Eigen::VectorXd> get_safe_regions_bs();
+		Eigen::VectorXd get_workspace_lower() { return workspace_lower_; };
+		Eigen::VectorXd get_workspace_upper() { return workspace_upper_; };
 
 	private:
 		double m_;
@@ -71,15 +85,18 @@ class DrakeSimulation
 		std::vector<Eigen::Matrix3Xd> obstacles_;
 		std::vector<Eigen::MatrixXd> safe_region_As_;
 		std::vector<Eigen::VectorXd> safe_region_bs_;
+		Eigen::VectorXd workspace_lower_;
+		Eigen::VectorXd workspace_upper_;
 };
 
 void simulate();
-void find_trajectory(
+trajopt::SolvedTrajectory find_trajectory(
 		Eigen::Vector3d init_pos,
 		Eigen::Vector3d final_pos,
-		int num_traj_segments,
+		int max_num_traj_segments,
 		std::vector<Eigen::MatrixXd> safe_region_As,
 		std::vector<Eigen::VectorXd> safe_region_bs,
-		trajopt::MISOSProblem* traj
+		Eigen::VectorXd workspace_lower,
+		Eigen::VectorXd workspace_upper
 		);
-void publish_traj_to_visualizer(trajopt::MISOSProblem* traj);
+void publish_traj_to_visualizer(const trajopt::SolvedTrajectory& traj);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <Eigen/Dense>
+#include "trajopt/MISOSProblem.h"
+#include "trajopt/SolvedTrajectory.h"
+#include "trajopt/planner.h"
+#include "trajopt/planner_context.h"
+#include "trajopt/region_graph_cache.h"
+#include "trajopt/region_tools.h"
+#include "simulate/simulate.h"
+
+void make_box_corridor(
+		int num_regions,
+		std::vector<Eigen::MatrixXd>* As,
+		std::vector<Eigen::VectorXd>* bs
+		);
+
+const std::vector<std::string> kObstacleScenes = {
+	"models/obstacles.urdf",
+	"models/obstacles_corridors.urdf",
+	"models/obstacles_forrest.urdf",
+	"models/obstacles_groups.urdf",
+	"models/obstacles_simple.urdf",
+	"models/obstacles_walls.urdf"
+};
+
+void calc_scene_regions(
+		const std::string& obstacle_model_path,
+		std::vector<Eigen::MatrixXd>* As,
+		std::vector<Eigen::VectorXd>* bs,
+		Eigen::VectorXd* workspace_lower,
+		Eigen::VectorXd* workspace_upper
+		);
+void calc_scene_regions(
+		const std::string& obstacle_model_path,
+		bool remove_redundant_halfspaces,
+		std::vector<Eigen::MatrixXd>* As,
+		std::vector<Eigen::VectorXd>* bs,
+		Eigen::VectorXd* workspace_lower,
+		Eigen::VectorXd* workspace_upper
+		);
+
+void benchmark_misos_construction();
+void benchmark_trajectory_sampling();
+void benchmark_big_M();
+void benchmark_region_formulations();
+void benchmark_redundant_halfspaces();
+void benchmark_symmetry_breaking();
+void benchmark_solver_backends();
+void benchmark_batch_planning();
+void benchmark_replanning();
+void benchmark_region_graph_cache();
@@ -6,6 +6,7 @@
 #include "plot/plotter.h"
 
 void test_trajectory_socp_fix_mi_variables();
+void test_trajectory_control_points();
 void test_trajopt();
 void test_polynomial_trajectory();
 void test_mathematical_program();
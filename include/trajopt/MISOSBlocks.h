@@ -0,0 +1,272 @@
+#pragma once
+
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+
+#include "trajopt/polynomial_basis.h"
+
+namespace trajopt
+{
+	// Numeric building blocks for a MISOSProblem with a fixed polynomial degree
+	// and a fixed number of variables (dimension of the trajectory).
+	// All blocks are fixed size, and all tables are computed at compile time.
+	template <int Degree, int Dim>
+	struct MISOSBlocks
+	{
+		static constexpr int kNumCoeffs = Degree + 1;
+		static constexpr int kNumSegmentVars = Dim * kNumCoeffs;
+
+		// Polynomials of degree 3 get a SOCP certificate, all others
+		// get SOS certificates (PSD Gram matrices)
+		static constexpr bool kUseSocpCertificate = Degree == 3;
+		static constexpr int kGramSize = (Degree - 1) / 2 + 1;
+		static constexpr int kNumSigmaVars = kUseSocpCertificate
+			? Degree : kGramSize * (kGramSize + 1) / 2;
+		static constexpr int kNumCertificateVars = 2 * kNumSigmaVars;
+
+		// The cost is the integral of the squared snap, or of the highest
+		// nonzero derivative for lower degrees
+		static constexpr int kCostDerivativeOrder = Degree < 4 ? Degree : 4;
+		static constexpr int kNumCostCoeffs = kNumCoeffs - kCostDerivativeOrder;
+
+		using PointVector = Eigen::Matrix<double, Dim, 1>;
+		using CoeffVector = Eigen::Matrix<double, kNumCoeffs, 1>;
+		using DerivativeTable = Eigen::Matrix<double, kNumCoeffs, kNumCoeffs>;
+		using ContinuityMatrix = Eigen::Matrix<
+			double, Eigen::Dynamic, 2 * kNumCoeffs, Eigen::ColMajor,
+			kNumCoeffs, 2 * kNumCoeffs>;
+		using HalfspaceMatrix = Eigen::Matrix<double, kNumCoeffs, kNumSegmentVars + 1>;
+		using SigmaMap = Eigen::Matrix<double, Degree, kNumSigmaVars>;
+		using CertificateMap = Eigen::Matrix<double, kNumCoeffs, kNumCertificateVars>;
+		using CostFactor = Eigen::Matrix<double, kNumCostCoeffs, kNumCostCoeffs>;
+
+		// kDerivativeFactors[k][n] = n! / (n - k)!
+		static constexpr std::array<std::array<double, kNumCoeffs>, kNumCoeffs>
+			make_derivative_factors()
+		{
+			std::array<std::array<double, kNumCoeffs>, kNumCoeffs> factors {};
+			for (int k = 0; k < kNumCoeffs; ++k)
+				for (int n = 0; n < kNumCoeffs; ++n)
+					factors[k][n] = derivative_factor(n, k);
+			return factors;
+		}
+		static constexpr auto kDerivativeFactors = make_derivative_factors();
+
+		// kBernsteinFactors[n][k] = (k choose n) / (Degree choose n), such that
+		// the Bernstein control points of a segment are P_k = sum_n c_n * kBernsteinFactors[n][k]
+		static constexpr std::array<std::array<double, kNumCoeffs>, kNumCoeffs>
+			make_bernstein_factors()
+		{
+			std::array<std::array<double, kNumCoeffs>, kNumCoeffs> factors {};
+			for (int n = 0; n < kNumCoeffs; ++n)
+				for (int k = 0; k < kNumCoeffs; ++k)
+					factors[n][k] = bernstein_factor(Degree, n, k);
+			return factors;
+		}
+		static constexpr auto kBernsteinFactors = make_bernstein_factors();
+
+		// (d/dt)^k of the monomial basis evaluated at t, one row per k
+		static DerivativeTable derivative_table(double t)
+		{
+			DerivativeTable table = DerivativeTable::Zero();
+			for (int k = 0; k < kNumCoeffs; ++k)
+			{
+				double t_pow = 1.0;
+				for (int n = k; n < kNumCoeffs; ++n)
+				{
+					table(k, n) = kDerivativeFactors[k][n] * t_pow;
+					t_pow *= t;
+				}
+			}
+			return table;
+		}
+
+		// Q with c^T * Q * c = int_0^1 ((d/dt)^Order sum_n c_n t^n)^2 dt, i.e.
+		// Q(n, m) = n! / (n - Order)! * m! / (m - Order)! / (n + m - 2 * Order + 1)
+		// for n, m >= Order and zero otherwise. Computed once per Degree and Order.
+		template <int Order>
+		static const DerivativeTable& integral_hessian()
+		{
+			static const DerivativeTable hessian = []()
+			{
+				DerivativeTable Q = DerivativeTable::Zero();
+				for (int n = Order; n < kNumCoeffs; ++n)
+					for (int m = Order; m < kNumCoeffs; ++m)
+						Q(n, m) = kDerivativeFactors[Order][n] * kDerivativeFactors[Order][m]
+							/ (n + m - 2 * Order + 1);
+				return Q;
+			}();
+			return hessian;
+		}
+
+		// Upper triangular R with R^T * R equal to the nonzero block of
+		// integral_hessian<kCostDerivativeOrder>(), such that the cost of one
+		// variable is || R * c(kCostDerivativeOrder:) ||^2
+		static const CostFactor& cost_factor()
+		{
+			static const CostFactor factor = []()
+			{
+				const CostFactor Q = integral_hessian<kCostDerivativeOrder>()
+					.template bottomRightCorner<kNumCostCoeffs, kNumCostCoeffs>();
+				return CostFactor(Q.llt().matrixU());
+			}();
+			return factor;
+		}
+
+		// [D(1), -D(0)] for derivative orders 0, ..., continuity_degree,
+		// such that continuity_block * [c_j; c_j+1] = 0 for one variable
+		static ContinuityMatrix continuity_block(int continuity_degree)
+		{
+			static const DerivativeTable table_t0 = derivative_table(0.0);
+			static const DerivativeTable table_t1 = derivative_table(1.0);
+
+			ContinuityMatrix A(continuity_degree + 1, 2 * kNumCoeffs);
+			A << table_t1.topRows(continuity_degree + 1),
+					-table_t0.topRows(continuity_degree + 1);
+			return A;
+		}
+
+		// Coefficients in t of q(t) = big_M * (1 - h) + b - r - a^T * C * m(t)
+		// written as A_q * [vec(C); h] + b_q, with vec(C) stacked column by column.
+		// Use big_M = 0 to always enforce the halfspace.
+		static void halfspace_block(
+				const PointVector& a, double b, double radius, double big_M,
+				HalfspaceMatrix* A_q, CoeffVector* b_q
+				)
+		{
+			A_q->setZero();
+			for (int k = 0; k < kNumCoeffs; ++k)
+				A_q->template block<1, Dim>(k, k * Dim) = -a.transpose();
+			(*A_q)(0, kNumSegmentVars) = -big_M;
+
+			b_q->setZero();
+			(*b_q)(0) = b - radius + big_M;
+		}
+
+		// Perspective of the halfspace for the convex hull formulation,
+		// q(t) = h * (b - radius) - a^T * C * m(t) in the same form as halfspace_block.
+		// Here C is the copy of the coefficients for this region, which is zero if h = 0.
+		static void perspective_halfspace_block(
+				const PointVector& a, double b, double radius,
+				HalfspaceMatrix* A_q, CoeffVector* b_q
+				)
+		{
+			halfspace_block(a, 0.0, 0.0, 0.0, A_q, b_q);
+			(*A_q)(0, kNumSegmentVars) = b - radius;
+		}
+
+		// a^T * P_k + big_M * h <= b - radius + big_M for all control points P_k,
+		// written as A_p * [vec(C); h] <= ub_p. The segment is inside the halfspace
+		// if all control points are, as it is in their convex hull on [0, 1].
+		static void control_point_block(
+				const PointVector& a, double b, double radius, double big_M,
+				HalfspaceMatrix* A_p, CoeffVector* ub_p
+				)
+		{
+			for (int k = 0; k < kNumCoeffs; ++k)
+			{
+				for (int n = 0; n < kNumCoeffs; ++n)
+					A_p->template block<1, Dim>(k, n * Dim) =
+						kBernsteinFactors[n][k] * a.transpose();
+				(*A_p)(k, kNumSegmentVars) = big_M;
+			}
+			ub_p->setConstant(b - radius + big_M);
+		}
+
+		// Perspective of the control point constraints,
+		// a^T * P_k - h * (b - radius) <= 0 for the per region coefficient copy
+		static void perspective_control_point_block(
+				const PointVector& a, double b, double radius,
+				HalfspaceMatrix* A_p, CoeffVector* ub_p
+				)
+		{
+			control_point_block(a, 0.0, 0.0, 0.0, A_p, ub_p);
+			A_p->col(kNumSegmentVars).setConstant(-(b - radius));
+		}
+
+		// Coefficients of sigma(t) in terms of its certificate variables
+		static SigmaMap sigma_map()
+		{
+			SigmaMap S = SigmaMap::Zero();
+			if constexpr (kUseSocpCertificate)
+				S.setIdentity();
+			else
+			{
+				// Upper triangle of the Gram matrix
+				int index = 0;
+				for (int row = 0; row < kGramSize; ++row)
+					for (int col = row; col < kGramSize; ++col)
+					{
+						S(row + col, index) = row == col ? 1.0 : 2.0;
+						++index;
+					}
+			}
+			return S;
+		}
+
+		// Maps the certificate variables [sigma_1; sigma_2] to the coefficients of
+		// q(t) = t * sigma_1(t) + (1 - t) * sigma_2(t)
+		static const CertificateMap& certificate_map()
+		{
+			static const CertificateMap map = []()
+			{
+				Eigen::Matrix<double, kNumCoeffs, Degree> T_1 =
+					Eigen::Matrix<double, kNumCoeffs, Degree>::Zero();
+				Eigen::Matrix<double, kNumCoeffs, Degree> T_2 =
+					Eigen::Matrix<double, kNumCoeffs, Degree>::Zero();
+				for (int k = 0; k < Degree; ++k)
+				{
+					T_1(k + 1, k) = 1.0;
+					T_2(k, k) = 1.0;
+					T_2(k + 1, k) = -1.0;
+				}
+
+				const SigmaMap S = sigma_map();
+				CertificateMap M;
+				M << T_1 * S, T_2 * S;
+				return M;
+			}();
+			return map;
+		}
+	};
+
+	// Calls f(Degree, Dim) with std::integral_constants for the supported problem
+	// sizes, and throws std::invalid_argument for any other size
+	template <int Degree, typename Function>
+	void dispatch_num_vars(int num_vars, Function&& f)
+	{
+		switch (num_vars)
+		{
+			case 2:
+				f(std::integral_constant<int, Degree>(), std::integral_constant<int, 2>());
+				break;
+			case 3:
+				f(std::integral_constant<int, Degree>(), std::integral_constant<int, 3>());
+				break;
+			default:
+				throw std::invalid_argument("Unsupported number of variables, must be 2 or 3");
+		}
+	}
+
+	template <typename Function>
+	void dispatch_problem_size(int degree, int num_vars, Function&& f)
+	{
+		switch (degree)
+		{
+			case 3:
+				dispatch_num_vars<3>(num_vars, f);
+				break;
+			case 5:
+				dispatch_num_vars<5>(num_vars, f);
+				break;
+			case 7:
+				dispatch_num_vars<7>(num_vars, f);
+				break;
+			default:
+				throw std::invalid_argument("Unsupported polynomial degree, must be 3, 5 or 7");
+		}
+	}
+} // namespace trajopt
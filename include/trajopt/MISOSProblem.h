@@ -4,18 +4,92 @@
 #include <drake/solvers/mathematical_program.h>
 #include <drake/solvers/solve.h>
 #include <drake/solvers/mosek_solver.h>
+#include <drake/solvers/gurobi_solver.h>
+#include <drake/solvers/choose_best_solver.h>
+#include <drake/solvers/branch_and_bound.h>
+#include <drake/solvers/scs_solver.h>
 #include <drake/common/trajectories/piecewise_polynomial.h>
+#include <chrono>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
 #include <Eigen/Core>
 
+#include "trajopt/polynomial_basis.h"
+#include "trajopt/MISOSBlocks.h"
+#include "trajopt/SolvedTrajectory.h"
+#include "trajopt/region_graph.h"
+#include "trajopt/region_tools.h"
+
 
 namespace trajopt
 {
 	typedef Eigen::MatrixX<drake::symbolic::Expression> coeff_matrix_t;
 
+	// Trajectory must keep this distance to the region boundaries
+	inline constexpr double kVehicleRadius = 0.2;
+
+	// Solver termination codes for a time limit
+	// (MSK_RES_TRM_MAX_TIME and GRB_TIME_LIMIT)
+	inline constexpr int kMosekTerminatedMaxTime = 10001;
+	inline constexpr int kGurobiTimeLimit = 9;
+
+	// How a segment is constrained to lie inside a region
+	enum class RegionContainment
+	{
+		// Each halfspace polynomial is certified nonnegative on [0, 1]. Exact, but
+		// needs SOS (semidefinite) constraints for degrees above 3.
+		kSosCertificate,
+		// All Bernstein control points of the segment lie in the region.
+		// Sufficient only, but linear at any degree.
+		kControlPoints
+	};
+
+	// How the choice of region for each segment is encoded with the binaries H
+	enum class RegionFormulation
+	{
+		// Region constraints are relaxed by big_M * (1 - h)
+		kBigM,
+		// Each segment has one copy of its coefficients per region, scaled by h
+		// in the perspective of the region constraints. Tighter relaxation,
+		// but more continuous variables.
+		kConvexHull
+	};
+
+	// Outcome of the last solve
+	enum class SolveStatus
+	{
+		kOptimal,
+		// Feasible, but the solver stopped at the time limit
+		kFeasible,
+		// Infeasible, or no feasible solution within the time limit
+		kNoSolution
+	};
+
+	// Statistics of the last solve, the same for all solver backends
+	struct SolverStatistics
+	{
+		std::string solver_name;
+		SolveStatus solve_status = SolveStatus::kNoSolution;
+		double cost = std::numeric_limits<double>::quiet_NaN();
+		// -infinity if the solver does not report a bound
+		double lower_bound = -std::numeric_limits<double>::infinity();
+		// Wall clock time of generate(), including all lazy iterations [s]
+		double solve_time = 0;
+		// Explored branch-and-bound nodes over all lazy iterations,
+		// -1 if the solver does not report them
+		int num_nodes = -1;
+	};
+
+	std::ostream& operator<<(std::ostream& os, const SolveStatus& status);
+	std::ostream& operator<<(std::ostream& os, const SolverStatistics& statistics);
+
 	class MISOSProblem
 	{
 		public:
+			// Supports degree 3, 5 or 7 and 2 or 3 variables, the program blocks are
+			// fixed size (see MISOSBlocks.h). Throws std::invalid_argument otherwise.
 			MISOSProblem(
 					const int num_traj_segments,
 					const int num_vars,
@@ -24,6 +98,17 @@ namespace trajopt
 					Eigen::VectorX<double> init_cond,
 					Eigen::VectorX<double> final_cond
 					);
+			// Segment j lasts segment_durations[j]. Each segment is still a polynomial
+			// on [0, 1] in the program, and is rescaled in the solved trajectory.
+			MISOSProblem(
+					const int num_traj_segments,
+					const int num_vars,
+					const int degree,
+					const int continuity_degree,
+					Eigen::VectorX<double> init_cond,
+					Eigen::VectorX<double> final_cond,
+					const std::vector<double>& segment_durations
+					);
 
 			void add_region_constraint(
 					int region_number, int segment_number
@@ -34,6 +119,11 @@ namespace trajopt
 			void add_region_constraint(
 					int region_number, int segment_number, bool always_enforce
 					);
+			// Only the given halfspaces (rows of A_r) of the region
+			void add_region_halfspaces(
+					int region_number, int segment_number,
+					const std::vector<int>& halfspaces, bool always_enforce
+					);
 			void add_safe_region_assignments(
 					Eigen::MatrixX<int>
 					);
@@ -41,12 +131,113 @@ namespace trajopt
 					std::vector<Eigen::MatrixX<double>> As,
 					std::vector<Eigen::VectorX<double>> bs
 					);
-			void create_region_binary_variables();
-			void generate();
+			// Halfspaces shared by all regions, such as the workspace bounds removed
+			// from each region with remove_box_facets. Enforced once for every segment,
+			// independent of the region binaries. Must be called after add_convex_regions.
+			// Not supported with the convex hull formulation.
+			void add_shared_halfspaces(
+					const Eigen::MatrixXd& A, const Eigen::VectorXd& b
+					);
+			// Computes the smallest valid big M for each region halfspace from the
+			// workspace box the regions were computed in (SafeRegions::set_bounds).
+			// Without bounds, the same default big M is used for all halfspaces.
+			void set_workspace_bounds(
+					const Eigen::VectorXd& lower, const Eigen::VectorXd& upper
+					);
+			// Precomputed big M for each region halfspace, with the shared halfspaces
+			// last, instead of computing them for every problem. Must be called after
+			// add_convex_regions and add_shared_halfspaces.
+			void set_big_M(const std::vector<Eigen::VectorXd>& big_M);
+			// Must be called before any region constraints are added
+			void set_region_containment(RegionContainment region_containment);
+			// Must be called before create_region_binary_variables
+			void set_region_formulation(RegionFormulation region_formulation);
+			// Starts without any region halfspaces, and after each solve adds the
+			// halfspaces violated by the solution and solves again until none are.
+			// Only supported for the big M formulation, and must be called
+			// before create_region_binary_variables.
+			void set_lazy_region_constraints(bool lazy_region_constraints);
+			// Symmetry breaking cuts, which remove assignments that only differ in
+			// the order the regions are visited in. Both need the region graph, and
+			// must be set before create_region_binary_variables.
+			// The region graph distance from the start never decreases along the segments.
+			// Can remove trajectories that go back towards the start.
+			void set_monotone_region_order(bool monotone_region_order);
+			// A region is not entered again once it is left
+			void set_no_return_cuts(bool no_return_cuts);
+			// Fixes segment j to region regions[j] for the first regions.size()
+			// segments, and prunes the regions the remaining segments can reach
+			// from the last fixed region. Used for the nodes of RegionBranchAndBound.
+			// Must be called before create_region_binary_variables.
+			void set_fixed_region_prefix(const std::vector<int>& regions);
+			// Prunes the region binaries only by the distance to the goal, and not
+			// by the distance from the start, so that the start can be moved with
+			// update_initial_state. Not supported with the monotone region order.
+			// Must be called before create_region_binary_variables.
+			void set_replanning(bool replanning);
+			// Prunes the region binaries with the region overlap graph,
+			// must be called before create_region_binary_variables
+			void add_region_graph(const RegionGraph* region_graph);
+			void create_region_binary_variables()
+			{
+				create_region_binary_variables(false);
+			};
+			// With relax_binaries, H is continuous in [0, 1] instead of binary,
+			// which gives the root relaxation of the mixed-integer problem
+			void create_region_binary_variables(bool relax_binaries);
+			void set_initial_guess(const SolvedTrajectory& traj);
+			// Initial guess for the region binaries, which the solver can use
+			// to construct an incumbent. Must be called after create_region_binary_variables.
+			void set_initial_guess(const Eigen::MatrixX<int>& region_assignments);
+			// Solver used by generate(), by default the one chosen by Drake
+			void set_solver_id(const drake::solvers::SolverId& solver_id);
+			// Solves the mixed-integer problem with Drake's branch-and-bound, with
+			// the relaxation at each node solved by the given conic solver, e.g.
+			// ScsSolver::id(). Needs no commercial solver license. Problems without
+			// binaries are solved with the conic solver directly. The time limit and
+			// the initial guesses are not used by the branch-and-bound.
+			void set_branch_and_bound(const drake::solvers::SolverId& node_solver_id);
+			// Wall clock limit for the solver [s]
+			void set_time_limit(double seconds);
+			// Print the lazy region constraint iterations and the solver
+			// statistics after each solve
+			void set_verbose(bool verbose);
+			SolvedTrajectory generate();
+			// Same as generate(), but returns false instead of asserting
+			// if no solution was found
+			bool try_generate(SolvedTrajectory* traj);
+			// Receding horizon replanning: replaces the start position, velocity and
+			// acceleration (columns of init_state) in the existing program, without
+			// rebuilding it. Needs set_replanning for problems with region binaries.
+			void update_initial_state(const Eigen::MatrixXd& init_state);
+			// Replaces the segment durations in the existing program, without
+			// rebuilding it, e.g. to search over the time allocation
+			void update_segment_durations(const std::vector<double>& segment_durations);
+			// Updates the start and solves again, warm started from the last solution
+			// shifted by time_shift (the time since its start) if there is one, with the
+			// region assignments shifted by the whole segments that have passed
+			bool replan(
+					const Eigen::MatrixXd& init_state,
+					double time_shift,
+					SolvedTrajectory* traj
+					);
 			Eigen::MatrixX<int> get_region_assignments();
+			// Solution of H without rounding, e.g. of the relaxed binaries
+			Eigen::MatrixXd get_region_weights();
 			double get_end_time();
+			double get_cost();
+			SolveStatus get_solve_status();
+			// Best lower bound on the optimal cost known by the solver,
+			// -infinity if the solver does not report one
+			double get_lower_bound();
+			const SolverStatistics& get_solver_statistics() { return statistics_; };
+			// Number of re-solves with added halfspaces in the last generate()
+			int get_num_lazy_iterations() { return num_lazy_iterations_; };
+			// Number of region halfspaces currently in the program
+			int get_num_region_halfspaces() { return num_region_halfspaces_; };
 			Eigen::VectorX<double> eval(double t);
 			Eigen::VectorX<double> eval_derivative(double t, int degree);
+			const SolvedTrajectory& get_trajectory();
 
 		private:
 			const int num_vars_;
@@ -55,28 +246,102 @@ namespace trajopt
 			const int num_traj_segments_;
 			int num_regions_;
 			const double vehicle_radius_;
-			const double big_M_ = 10; // TODO just set arbitrary: set better?
+			Eigen::VectorX<double> init_cond_;
+			const Eigen::VectorX<double> final_cond_;
+			std::vector<double> segment_durations_;
+			const RegionGraph* region_graph_ = nullptr;
+			RegionContainment region_containment_ = RegionContainment::kSosCertificate;
+			RegionFormulation region_formulation_ = RegionFormulation::kBigM;
+			const double default_big_M_ = 10;
+			Eigen::VectorXd workspace_lower_;
+			Eigen::VectorXd workspace_upper_;
+			// big_M_[r](i) is used for halfspace i of region r
+			std::vector<Eigen::VectorXd> big_M_;
+			bool lazy_region_constraints_ = false;
+			bool monotone_region_order_ = false;
+			bool no_return_cuts_ = false;
+			bool replanning_ = false;
+			bool verbose_ = false;
+			std::vector<int> fixed_region_prefix_;
+			// pending_halfspaces_[j][r] are the halfspaces of region r not yet added
+			// for segment j, empty if r is unreachable
+			std::vector<std::vector<std::vector<int>>> pending_halfspaces_;
+			int num_lazy_iterations_ = 0;
+			int num_region_halfspaces_ = 0;
 
+			// The shared halfspaces are stored after the regions, at index num_regions_
 			std::vector<Eigen::MatrixX<double>> regions_A_;
 			std::vector<Eigen::VectorX<double>> regions_b_;
 
-			Eigen::VectorX<drake::symbolic::Expression> m_;
-			// Vector of monomial basis functions
-
 			drake::symbolic::Variable t_;
-			std::vector<coeff_matrix_t> coeffs_;
-			Eigen::MatrixX<drake::symbolic::Expression> H_;
-			std::vector<std::vector<coeff_matrix_t>> coeffs_d_;
+			std::vector<drake::solvers::MatrixXDecisionVariable> coeffs_;
+			drake::solvers::MatrixXDecisionVariable H_;
+			// region_coeffs_[j][r] is the copy of coeffs_[j] for region r
+			// in the convex hull formulation, empty if r is unreachable
+			std::vector<std::vector<drake::solvers::MatrixXDecisionVariable>> region_coeffs_;
 			drake::solvers::MathematicalProgram prog_;
+			// Start position, velocity and acceleration of each variable
+			std::vector<drake::solvers::Binding<drake::solvers::LinearEqualityConstraint>>
+				init_constraints_;
+			// Between segments j and j + 1 for variable i at j * num_vars_ + i
+			std::vector<drake::solvers::Binding<drake::solvers::LinearEqualityConstraint>>
+				continuity_constraints_;
+			// Cost bound of each segment
+			std::vector<drake::solvers::Binding<drake::solvers::RotatedLorentzConeConstraint>>
+				cost_cones_;
+			// Constraint data for unit segment durations
+			Eigen::MatrixXd unit_continuity_A_;
+			Eigen::MatrixXd unit_init_A_;
+			Eigen::MatrixXd cost_cone_A_;
+			int cost_derivative_order_ = 0;
 
+			std::optional<drake::solvers::SolverId> solver_id_;
+			std::optional<drake::solvers::SolverId> branch_and_bound_solver_id_;
+			bool has_binary_variables_ = false;
+			// Of the last solve_branch_and_bound()
+			double branch_and_bound_lower_bound_ = -std::numeric_limits<double>::infinity();
+			SolverStatistics statistics_;
+			drake::solvers::SolverOptions solver_options_;
 			drake::solvers::MathematicalProgramResult result_;
-			Eigen::MatrixX<drake::symbolic::Polynomial> polynomials_;
-			std::vector<Eigen::MatrixX<drake::symbolic::Polynomial>> polynomial_derivatives_;
+			SolvedTrajectory trajectory_;
 
-			Eigen::VectorX<drake::symbolic::Expression> get_coefficients_in_t(drake::symbolic::Polynomial p);
+			drake::solvers::VectorXDecisionVariable get_coefficient_vector(int segment_number);
+			// Scaled to the current segment durations
+			Eigen::MatrixXd get_continuity_A(int j) const;
+			Eigen::MatrixXd get_init_A() const;
+			Eigen::VectorXd get_cost_cone_b(int j) const;
+			void solve();
+			void solve_program();
+			void solve_branch_and_bound();
+			bool add_violated_region_halfspaces();
+			void calc_big_M();
+			Eigen::MatrixX<bool> get_reachable_regions();
+			void add_region_transition_constraints(const Eigen::MatrixX<bool>& reachable);
+			void add_monotone_region_order_constraints();
+			void add_no_return_constraints(const Eigen::MatrixX<bool>& reachable);
+			void add_region_coefficient_copies(const Eigen::MatrixX<bool>& reachable);
+			drake::solvers::VectorXDecisionVariable get_region_constraint_vars(
+					int region_number, int segment_number, bool always_enforce
+					);
 
-			void generate_polynomials();
-			void generate_derivative_polynomials();
+			// Fixed size implementations, selected at runtime
+			// from degree_ and num_vars_ by dispatch_problem_size
+			template <int Degree, int Dim>
+			void add_trajectory_constraints(
+					const Eigen::VectorX<double>& init_cond,
+					const Eigen::VectorX<double>& final_cond
+					);
+			template <int Degree, int Dim>
+			void add_region_constraint_impl(
+					int region_number, int segment_number,
+					const std::vector<int>& halfspaces, bool always_enforce
+					);
+			template <int Degree, int Dim>
+			void add_control_point_constraint_impl(
+					int region_number, int segment_number,
+					const std::vector<int>& halfspaces, bool always_enforce
+					);
+			template <int Degree, int Dim>
+			drake::solvers::VectorXDecisionVariable add_nonnegativity_certificate();
 	};
-	int factorial(int n);
-	}
+}
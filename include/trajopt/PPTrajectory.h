@@ -2,9 +2,12 @@
 
 #include <drake/solvers/mathematical_program.h>
 #include <drake/solvers/solve.h>
+#include <drake/solvers/choose_best_solver.h>
 #include <iostream>
+#include <optional>
 #include <Eigen/Dense>
 #include "iris/iris.h"
+#include "trajopt/polynomial_basis.h"
 
 namespace trajopt
 {
@@ -19,6 +22,8 @@ namespace trajopt
 					);
 
 			void generate();
+			// Solver used by generate(), by default the one chosen by Drake
+			void set_solver_id(const drake::solvers::SolverId& solver_id);
 			Eigen::VectorX<drake::symbolic::Expression> eval_symbolic(
 					const double t
 					);
@@ -41,10 +46,10 @@ namespace trajopt
 			const int degree_;
 			const int continuity_degree_;
 			drake::solvers::MathematicalProgramResult result_;
+			std::optional<drake::solvers::SolverId> solver_id_;
 			std::vector<drake::solvers::MatrixXDecisionVariable> coeffs_;
 
 
 			drake::solvers::MathematicalProgram prog_;
 	};
-	int factorial(int n);
 }
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include <Eigen/Core>
+
+#include "trajopt/polynomial_basis.h"
+
+namespace trajopt
+{
+	// Preallocated structure-of-arrays buffer for batch sampling.
+	// Column k * num_vars + i holds all samples of derivative order k of variable i.
+	struct TrajectorySamples
+	{
+		TrajectorySamples(int num_vars, int max_derivative_order, int num_samples)
+			: num_vars(num_vars),
+				max_derivative_order(max_derivative_order),
+				values(num_samples, num_vars * (max_derivative_order + 1))
+		{}
+
+		Eigen::MatrixXd::ColXpr get(int derivative_order, int var)
+		{ return values.col(derivative_order * num_vars + var); };
+		Eigen::MatrixXd::ConstColXpr get(int derivative_order, int var) const
+		{ return values.col(derivative_order * num_vars + var); };
+		// All variables of one derivative order at sample s
+		Eigen::VectorXd get_sample(int derivative_order, int s) const
+		{ return values.row(s).segment(derivative_order * num_vars, num_vars).transpose(); };
+		int num_samples() const { return values.rows(); };
+
+		int num_vars;
+		int max_derivative_order;
+		Eigen::MatrixXd values;
+	};
+
+	// Immutable, numeric piecewise polynomial trajectory.
+	// Segment j is a polynomial in the local time t - breaks[j], and all
+	// coefficients are stored in one contiguous array.
+	// Holds no reference to the program it was solved from, and can be
+	// copied freely and evaluated from several threads at once.
+	class SolvedTrajectory
+	{
+		public:
+			SolvedTrajectory();
+			// Segments on unit intervals [j, j + 1]
+			SolvedTrajectory(const std::vector<Eigen::MatrixXd>& segment_coeffs);
+			// segment_coeffs[j] is num_vars x (degree + 1),
+			// with the coefficient of t^n in column n
+			SolvedTrajectory(
+					const std::vector<Eigen::MatrixXd>& segment_coeffs,
+					const std::vector<double>& breaks
+					);
+
+			Eigen::VectorXd eval(double t) const;
+			Eigen::VectorXd eval_derivative(double t, int derivative_order) const;
+			// Position and all derivatives up to the polynomial degree,
+			// one column per derivative order
+			Eigen::MatrixXd eval_all_derivatives(double t) const;
+			void eval_all_derivatives(double t, Eigen::Ref<Eigen::MatrixXd> out) const;
+			// Evaluates all derivatives up to samples->max_derivative_order at all times.
+			// Consecutive times on the same segment are evaluated together
+			// with vectorized Horner steps.
+			void eval_batch(
+					const Eigen::Ref<const Eigen::VectorXd>& times,
+					TrajectorySamples* samples
+					) const;
+
+			int get_num_vars() const { return num_vars_; };
+			int get_degree() const { return degree_; };
+			int get_num_segments() const { return num_segments_; };
+			double get_start_time() const { return breaks_.front(); };
+			double get_end_time() const { assert(num_segments_ > 0); return breaks_.back(); };
+			const std::vector<double>& get_breaks() const { return breaks_; };
+			Eigen::MatrixXd get_segment_coeffs(int segment_number) const;
+
+		private:
+			int num_vars_;
+			int degree_;
+			int num_segments_;
+			bool uniform_segments_;
+			double segment_duration_;
+
+			std::vector<double> breaks_;
+			// Coefficient n of variable i in segment j is at
+			// (j * num_vars + i) * (degree + 1) + n
+			std::vector<double> coeffs_;
+			// derivative_factors_[k * (degree + 1) + n] = n! / (n - k)!
+			std::vector<double> derivative_factors_;
+
+			int find_segment(double t) const;
+			const double* segment_coeffs_ptr(int segment_number, int var) const;
+			double horner(const double* c, int derivative_order, double t_rel) const;
+	};
+
+	// traj(t + time_shift) on the given breaks, such as the previous solution
+	// moved to the current time for a warm start. Each segment interpolates the
+	// shifted trajectory at degree + 1 Chebyshev points, which is exact where
+	// traj is a single polynomial. Times past the end of traj hold its end point.
+	SolvedTrajectory shift_trajectory(
+			const SolvedTrajectory& traj,
+			double time_shift,
+			const std::vector<double>& breaks
+			);
+} // namespace trajopt
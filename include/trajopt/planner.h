@@ -0,0 +1,331 @@
+#pragma once
+
+#include <iostream>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "trajopt/MISOSProblem.h"
+#include "trajopt/SolvedTrajectory.h"
+#include "trajopt/region_graph.h"
+#include "trajopt/region_graph_cache.h"
+#include "trajopt/portfolio.h"
+#include "trajopt/region_branch_and_bound.h"
+#include "trajopt/time_allocation.h"
+
+namespace trajopt
+{
+	struct PlannerOptions
+	{
+		int num_vars = 3;
+		// Mixed-integer stage, finds the region assignments
+		int mip_degree = 3;
+		int mip_continuity_degree = 2;
+		// Fixed assignment stage, finds the final trajectory
+		int degree = 5;
+		int continuity_degree = 4;
+		// With kControlPoints the mixed-integer problem is linear in the
+		// coefficients at any degree, and is solved in a single stage at degree
+		RegionContainment region_containment = RegionContainment::kSosCertificate;
+		// Prune the region binaries with the region overlap graph
+		bool use_region_graph = true;
+		// Directory of the on-disk cache of the region overlap graph, which is
+		// loaded instead of built if the regions are unchanged (see region_graph_cache.h).
+		// Not used if empty.
+		std::string region_graph_cache_dir;
+		// Symmetry breaking cuts on the region binaries, need the region graph.
+		// See MISOSProblem::set_monotone_region_order and set_no_return_cuts.
+		bool monotone_region_order = false;
+		bool no_return_cuts = false;
+		RegionFormulation region_formulation = RegionFormulation::kBigM;
+		// Add the region halfspaces of the mixed-integer problem only once they
+		// are violated, see MISOSProblem::set_lazy_region_constraints.
+		// Ignored for the convex hull formulation.
+		bool lazy_region_constraints = false;
+		// Use the smallest valid big M per region halfspace,
+		// requires the workspace bounds to be set
+		bool use_tight_big_M = true;
+		// Remove the workspace bounds facets from every region and constrain each
+		// segment to the workspace box once instead, requires the workspace bounds.
+		// Ignored for the convex hull formulation, which needs bounded regions.
+		bool share_bounds_facets = false;
+		// Try the region sequence of the shortest path through the region graph
+		// before the mixed-integer stage, and only solve the mixed-integer
+		// problem if that fails
+		bool use_graph_seed = true;
+		// Solve the relaxation of the region binaries, round it along the region
+		// graph and solve the fixed assignment problem before the mixed-integer
+		// problem. The rounded assignments are also the initial guess of the MIP.
+		bool use_relaxation_rounding = false;
+		// Always solve the mixed-integer problem for the optimal assignments
+		bool require_optimal = false;
+		// Configurations of the mixed-integer problem to race on separate threads.
+		// If empty, one problem is solved with the settings above and the
+		// requested number of segments. A portfolio of several configurations
+		// must not use branch_and_bound_solver_id, see PortfolioConfig.
+		std::vector<PortfolioConfig> portfolio;
+		// Time limit for each configuration in the portfolio [s], which also
+		// bounds the wait for the losing threads of the last race
+		double portfolio_time_limit = 10;
+		// Share of the time budget of plan_anytime() given to the
+		// mixed-integer problem, the rest is left for the fixed assignment stage
+		double anytime_mip_fraction = 0.7;
+		// Solve the mixed-integer problems with Drake's branch-and-bound over this
+		// conic solver (e.g. ScsSolver::id()), and the convex problems with the
+		// conic solver directly, instead of the best available (commercial) solver
+		std::optional<drake::solvers::SolverId> branch_and_bound_solver_id;
+		// Find the region assignments of plan() with RegionBranchAndBound,
+		// which branches along the region graph, instead of solving the
+		// mixed-integer problem. Ignored with a portfolio.
+		bool use_region_branch_and_bound = false;
+		RegionBranchAndBoundOptions region_branch_and_bound;
+		// After plan() and plan_auto_segments(), minimize the flight time
+		// with the region assignments fixed, subject to the dynamic limits.
+		// Otherwise each segment lasts one second.
+		bool optimize_time_allocation = false;
+		DynamicLimits dynamic_limits;
+		// Gradient steps on the relative segment durations
+		int time_allocation_iterations = 5;
+		// Print the solver statistics of each solve, see MISOSProblem::set_verbose.
+		// The region branch-and-bound has its own flag in its options.
+		bool verbose = false;
+	};
+
+	// Wall clock time spent in each stage of plan() [ms]
+	struct PlanTimings
+	{
+		double graph_search = 0;
+		double relaxation = 0;
+		double mip_build = 0;
+		double mip_solve = 0;
+		double fixed_build = 0;
+		double fixed_solve = 0;
+		double time_allocation = 0;
+		double total = 0;
+	};
+
+	enum class PlanStatus
+	{
+		// Assignments are optimal for the mixed-integer problem
+		kOptimal,
+		// Best mixed-integer incumbent at the deadline
+		kFeasible,
+		// Assignments from the graph search, without the mixed-integer problem
+		kHeuristic,
+		// No trajectory was found
+		kFailed
+	};
+
+	struct PlanResult
+	{
+		PlanStatus status = PlanStatus::kFailed;
+		SolvedTrajectory trajectory;
+		Eigen::MatrixX<int> region_assignments;
+		// Relative gap between the cost of the assignments and the best lower
+		// bound on the mixed-integer cost. NaN if no bound is known.
+		double mip_gap = std::numeric_limits<double>::quiet_NaN();
+		PlanTimings timings;
+	};
+
+	// Region data that only depends on the safe regions and the workspace
+	// bounds, computed once and shared by all problems built by a planner
+	struct PreparedRegions
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		// Workspace box, enforced once for every segment with
+		// share_bounds_facets, and empty otherwise
+		Eigen::MatrixXd shared_A;
+		Eigen::VectorXd shared_b;
+		// Tight big M of each halfspace with the shared halfspaces last,
+		// empty without workspace bounds or use_tight_big_M
+		std::vector<Eigen::VectorXd> big_M;
+	};
+
+	std::ostream& operator<<(std::ostream& os, const PlanTimings& timings);
+	std::ostream& operator<<(std::ostream& os, const PlanStatus& status);
+
+	// Two stage planner through a fixed set of convex safe regions:
+	// 1. A low degree mixed-integer problem finds the region assignments
+	// 2. A high degree problem with the assignments fixed finds the trajectory,
+	//    with the lifted low degree solution as initial guess. The guess is
+	//    ignored by interior point solvers such as Mosek's conic optimizer.
+	// With control point containment, stage 1 is solved at the final degree
+	// and stage 2 is skipped.
+	// Unless optimal assignments are required, the regions along the shortest
+	// path through the region graph are tried first, skipping stage 1.
+	// The planning methods do not modify the planner, and may be called from
+	// several threads at once (see PlannerContext).
+	class Planner
+	{
+		public:
+			Planner(
+					std::vector<Eigen::MatrixXd> safe_region_As,
+					std::vector<Eigen::VectorXd> safe_region_bs
+					);
+			// Throws std::invalid_argument if the portfolio races a configuration
+			// on Drake's branch-and-bound, which has no time limit
+			Planner(
+					std::vector<Eigen::MatrixXd> safe_region_As,
+					std::vector<Eigen::VectorXd> safe_region_bs,
+					PlannerOptions options
+					);
+
+			// Workspace box the safe regions were computed in
+			void set_workspace_bounds(
+					const Eigen::VectorXd& lower, const Eigen::VectorXd& upper
+					);
+
+			// Returns a kFailed result if no trajectory is found
+			PlanResult plan(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					int num_traj_segments
+					) const;
+			// Returns the best plan found within the time budget [ms]: from the
+			// mixed-integer incumbent if there is one and the fixed assignment stage
+			// succeeds on it, otherwise from the graph search assignments
+			// (kHeuristic), and kFailed if neither gives a trajectory.
+			// The budget is soft, as problem construction is not interrupted.
+			// With branch_and_bound_solver_id the solvers ignore the time limit,
+			// and the budget is not enforced.
+			PlanResult plan_anytime(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					int num_traj_segments,
+					double time_budget_ms
+					) const;
+			// Chooses the number of segments by iterative deepening: starts from the
+			// least number of regions on any region sequence from start to goal,
+			// and adds one segment at a time until a plan is found. Each step is
+			// warm started with the shortest region path spread over its segments.
+			// A step fails if the mixed-integer or the fixed assignment stage does.
+			// MIP timings are summed over all steps. The portfolio,
+			// use_relaxation_rounding and use_region_branch_and_bound options
+			// are ignored, each step solves one mixed-integer problem.
+			PlanResult plan_auto_segments(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					int max_num_traj_segments
+					) const;
+			// Number of regions on the region sequence from start to goal with
+			// the fewest transitions, or -1 if there is none
+			int get_min_num_segments(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos
+					) const;
+
+		private:
+			const std::vector<Eigen::MatrixXd> safe_region_As_;
+			const std::vector<Eigen::VectorXd> safe_region_bs_;
+			const PlannerOptions options_;
+			// Shared with the problem factories, which may outlive the planner
+			const std::shared_ptr<const RegionGraph> region_graph_;
+			Eigen::VectorXd workspace_lower_;
+			Eigen::VectorXd workspace_upper_;
+			std::shared_ptr<const PreparedRegions> prepared_regions_;
+			// Same as prepared_regions_, but never with shared bounds facets
+			std::shared_ptr<const PreparedRegions> hull_regions_;
+			// Losing threads of the portfolio races
+			std::shared_ptr<PortfolioThreads> portfolio_threads_;
+
+			void update_prepared_regions();
+			static bool is_single_stage(const PortfolioConfig& config);
+			// The configuration from the planner options
+			PortfolioConfig get_default_config(int num_traj_segments) const;
+			// The assignments guess is used for configurations with the same
+			// number of segments, and may be empty
+			problem_factory_t get_mip_factory(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					const Eigen::MatrixX<int>& assignments_guess
+					) const;
+			Eigen::MatrixX<int> get_rounded_assignments(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					int num_traj_segments
+					) const;
+			bool plan_from_graph_seed(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					int num_traj_segments,
+					PlanResult* result
+					) const;
+			Eigen::MatrixX<int> get_graph_seed_assignments(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					int num_traj_segments
+					) const;
+			// Builds a new program for every call. The mixed-integer program has
+			// a lower degree, so none of it is reused. optimize_time_allocation
+			// reuses one program instead. initial_guess may be nullptr.
+			bool solve_fixed_assignment(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					const Eigen::MatrixX<int>& region_assignments,
+					const SolvedTrajectory* initial_guess,
+					PlanTimings* timings,
+					SolvedTrajectory* traj
+					) const
+			{
+				return solve_fixed_assignment(
+						init_pos, final_pos, region_assignments, initial_guess,
+						std::numeric_limits<double>::infinity(), timings, traj
+						);
+			};
+			// With a time limit [s]
+			bool solve_fixed_assignment(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					const Eigen::MatrixX<int>& region_assignments,
+					const SolvedTrajectory* initial_guess,
+					double time_limit,
+					PlanTimings* timings,
+					SolvedTrajectory* traj
+					) const
+			{
+				return solve_fixed_assignment(
+						init_pos, final_pos, region_assignments,
+						std::vector<double>(region_assignments.cols(), 1.0),
+						initial_guess, time_limit, timings, traj
+						);
+			};
+			// With the duration of each segment [s]
+			bool solve_fixed_assignment(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					const Eigen::MatrixX<int>& region_assignments,
+					const std::vector<double>& segment_durations,
+					const SolvedTrajectory* initial_guess,
+					double time_limit,
+					PlanTimings* timings,
+					SolvedTrajectory* traj
+					) const;
+			// Safe regions and region assignments of the fixed assignment stage
+			std::unique_ptr<MISOSProblem> make_fixed_assignment_problem(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					const Eigen::MatrixX<int>& region_assignments,
+					const std::vector<double>& segment_durations
+					) const;
+			// Replaces the trajectory of a successful plan with the one of
+			// optimize_time_allocation(), if enabled in the options
+			void allocate_time(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					PlanResult* result
+					) const;
+			bool optimize_time_allocation(
+					const Eigen::VectorXd& init_pos,
+					const Eigen::VectorXd& final_pos,
+					const Eigen::MatrixX<int>& region_assignments,
+					const SolvedTrajectory& initial_guess,
+					SolvedTrajectory* traj
+					) const;
+	};
+
+	double elapsed_ms(std::chrono::high_resolution_clock::time_point start);
+} // namespace trajopt
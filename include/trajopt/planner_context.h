@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Core>
+
+#include "trajopt/planner.h"
+
+namespace trajopt
+{
+	struct PlanQuery
+	{
+		Eigen::VectorXd init_pos;
+		Eigen::VectorXd final_pos;
+		// With 0, the number of segments is chosen by plan_auto_segments()
+		int num_traj_segments = 0;
+	};
+
+	struct PlannerContextOptions
+	{
+		// 0 uses one thread per hardware thread
+		int num_threads = 0;
+		// Upper limit of plan_auto_segments() for queries without a number of segments
+		int max_num_traj_segments = 8;
+	};
+
+	// Plans many queries through the same safe regions. Everything that does not
+	// depend on the start and goal is computed once on construction: the region
+	// overlap graph, the normalized region facets with the workspace facets
+	// removed, and the tight big M of every halfspace. Each query only builds
+	// and solves its own problems.
+	class PlannerContext
+	{
+		public:
+			PlannerContext(
+					const std::vector<Eigen::MatrixXd>& safe_region_As,
+					const std::vector<Eigen::VectorXd>& safe_region_bs,
+					const Eigen::VectorXd& workspace_lower,
+					const Eigen::VectorXd& workspace_upper
+					);
+			PlannerContext(
+					const std::vector<Eigen::MatrixXd>& safe_region_As,
+					const std::vector<Eigen::VectorXd>& safe_region_bs,
+					const Eigen::VectorXd& workspace_lower,
+					const Eigen::VectorXd& workspace_upper,
+					PlannerOptions planner_options,
+					PlannerContextOptions options
+					);
+
+			PlanResult plan(const PlanQuery& query) const;
+			// Solves the queries concurrently on a pool of threads, which take the
+			// next unsolved query until none are left. Results and timings are
+			// returned in the order of the queries.
+			std::vector<PlanResult> plan_batch(const std::vector<PlanQuery>& queries) const;
+
+			const Planner& get_planner() const { return planner_; };
+
+		private:
+			const PlannerContextOptions options_;
+			Planner planner_;
+	};
+} // namespace trajopt
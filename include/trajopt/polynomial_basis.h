@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Eigen/Core>
+
+namespace trajopt
+{
+	int factorial(int n);
+
+	// Factor in front of t^(n - k) in (d/dt)^k t^n, i.e. n! / (n - k)!
+	constexpr double derivative_factor(int n, int k)
+	{
+		if (k > n) return 0.0;
+
+		double factor = 1.0;
+		for (int i = n - k + 1; i <= n; ++i) factor *= i;
+		return factor;
+	}
+
+	// Binomial coefficient n choose k
+	constexpr double binomial(int n, int k)
+	{
+		if (k < 0 || k > n) return 0.0;
+
+		double res = 1.0;
+		for (int i = 1; i <= k; ++i) res = res * (n - k + i) / i;
+		return res;
+	}
+
+	// (k choose n) / (degree choose n), entry (n,k) of monomial_to_bernstein
+	constexpr double bernstein_factor(int degree, int n, int k)
+	{
+		return binomial(k, n) / binomial(degree, n);
+	}
+
+	// Minimum of the polynomial sum_n coeffs(n) * t^n on [0, 1], attained at
+	// an end point or at a real root of the derivative
+	double min_on_unit_interval(const Eigen::VectorXd& coeffs);
+
+	// T(n,k) = (k choose n) / (degree choose n), such that the Bernstein
+	// control points of the polynomial with coefficient row vector c are c * T
+	Eigen::MatrixXd monomial_to_bernstein(int degree);
+} // namespace trajopt
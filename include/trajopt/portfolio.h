@@ -0,0 +1,79 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <Eigen/Core>
+
+#include "trajopt/MISOSProblem.h"
+#include "trajopt/SolvedTrajectory.h"
+
+namespace trajopt
+{
+	// One configuration of the region assignment problem
+	struct PortfolioConfig
+	{
+		int num_traj_segments;
+		RegionFormulation region_formulation = RegionFormulation::kBigM;
+		RegionContainment region_containment = RegionContainment::kSosCertificate;
+		// Drake chooses the solver if not set
+		std::optional<drake::solvers::SolverId> solver_id;
+		// Solve with Drake's branch-and-bound over this conic solver instead,
+		// see MISOSProblem::set_branch_and_bound. Overrides
+		// PlannerOptions::branch_and_bound_solver_id for this configuration.
+		// Drake's branch-and-bound has no time limit, so it cannot be raced
+		// against other configurations, and is only allowed in a portfolio
+		// of one configuration.
+		std::optional<drake::solvers::SolverId> branch_and_bound_solver_id;
+		// Solve the root relaxation instead, with H continuous in [0, 1]
+		bool relax_binaries = false;
+		// Regions of the first segments, see MISOSProblem::set_fixed_region_prefix
+		std::vector<int> fixed_region_prefix;
+	};
+
+	struct PortfolioResult
+	{
+		bool success = false;
+		// Index of the configuration that finished first
+		int config_index = -1;
+		SolveStatus solve_status = SolveStatus::kNoSolution;
+		SolvedTrajectory trajectory;
+		Eigen::MatrixX<int> region_assignments;
+	};
+
+	// Builds the problem for a configuration, without solving it.
+	// Is called on the solver threads, and must not refer to data
+	// that may be destroyed before all threads have finished.
+	typedef std::function<std::unique_ptr<MISOSProblem>(const PortfolioConfig&)>
+		problem_factory_t;
+
+	// Solver threads that are still running after solve_first_of returns.
+	// Drake offers no way to interrupt a running solve, so they are joined
+	// before the next race starts and on destruction instead.
+	class PortfolioThreads
+	{
+		public:
+			~PortfolioThreads();
+
+			void add(std::thread thread);
+			// Waits for all threads added so far
+			void join_all();
+
+		private:
+			std::mutex mutex_;
+			std::vector<std::thread> threads_;
+	};
+
+	// Builds and solves each configuration on its own thread, and returns the
+	// first solution found. The remaining threads are added to threads and
+	// their results discarded. Use MISOSProblem::set_time_limit in the factory
+	// to bound their run time, and with it the wait in PortfolioThreads.
+	PortfolioResult solve_first_of(
+			const std::vector<PortfolioConfig>& configs,
+			const problem_factory_t& make_problem,
+			PortfolioThreads* threads
+			);
+} // namespace trajopt
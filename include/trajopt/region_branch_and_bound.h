@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <Eigen/Core>
+
+#include "trajopt/MISOSProblem.h"
+#include "trajopt/SolvedTrajectory.h"
+#include "trajopt/region_graph.h"
+#include "trajopt/portfolio.h"
+
+namespace trajopt
+{
+	struct RegionBranchAndBoundOptions
+	{
+		// 0 uses one thread per hardware thread
+		int num_threads = 0;
+		// Nodes are pruned if their bound is within this relative gap of the incumbent
+		double relative_gap = 1e-4;
+		// The search stops with the incumbent after this many nodes
+		int max_nodes = 10000;
+		// Print the node count and bounds after the search
+		bool verbose = false;
+	};
+
+	struct RegionBranchAndBoundResult
+	{
+		bool success = false;
+		// False if the search stopped at max_nodes
+		bool optimal = false;
+		Eigen::MatrixX<int> region_assignments;
+		SolvedTrajectory trajectory;
+		double cost = std::numeric_limits<double>::infinity();
+		double lower_bound = -std::numeric_limits<double>::infinity();
+		int num_nodes = 0;
+	};
+
+	// Branch-and-bound over the region assignments of a MISOSProblem, which
+	// exploits the chain structure of the segments:
+	// - Branches on the region of one segment at a time, in time order,
+	//   and only into the regions the previous segment's region overlaps with
+	// - Bounds each node with the convex relaxation that has the regions of the
+	//   segments so far fixed (MISOSProblem::set_fixed_region_prefix)
+	// - Warm starts each node from the relaxed trajectory of its parent
+	// - Explores the nodes depth first on a work-stealing thread pool, with the
+	//   children of a node ordered by their relaxed weight in the parent
+	class RegionBranchAndBound
+	{
+		public:
+			// The factory is called with config.relax_binaries set and the fixed
+			// region prefix of the node. region_graph may be nullptr, in which case
+			// every region is a child of every node.
+			RegionBranchAndBound(
+					const PortfolioConfig& config,
+					const problem_factory_t& make_problem,
+					const RegionGraph* region_graph,
+					int num_regions,
+					RegionBranchAndBoundOptions options
+					);
+
+			// first_regions are the candidate regions of the first segment
+			RegionBranchAndBoundResult solve(const std::vector<int>& first_regions);
+
+		private:
+			struct Node
+			{
+				std::vector<int> fixed_regions;
+				// Relaxed cost of the parent, a lower bound for the node
+				double parent_bound;
+				std::shared_ptr<const SolvedTrajectory> parent_trajectory;
+			};
+
+			// Double ended queue of one worker. The owner takes the newest node
+			// (depth first), and idle workers steal the oldest one.
+			struct WorkerQueue
+			{
+				std::mutex mutex;
+				std::deque<Node> nodes;
+			};
+
+			const PortfolioConfig config_;
+			const problem_factory_t make_problem_;
+			const RegionGraph* region_graph_;
+			const int num_regions_;
+			const RegionBranchAndBoundOptions options_;
+
+			std::vector<std::unique_ptr<WorkerQueue>> queues_;
+			// Nodes pushed, but not yet processed
+			std::atomic<int> num_pending_;
+			// Idle workers wait on work_changed_ for a push, the end of the
+			// search or a stop. num_pushed_ is guarded by work_mutex_, as are the
+			// changes of num_pending_ that can wake a worker.
+			std::mutex work_mutex_;
+			std::condition_variable work_changed_;
+			int num_pushed_;
+			std::atomic<int> num_nodes_;
+			std::atomic<bool> stop_;
+
+			std::mutex incumbent_mutex_;
+			RegionBranchAndBoundResult incumbent_;
+
+			void run_worker(int worker);
+			bool pop_node(int worker, Node* node);
+			void push_node(int worker, Node node);
+			// Counts a popped node as done and wakes the idle workers if it ends the search
+			void finish_node();
+			void process_node(int worker, const Node& node);
+			double get_prune_threshold();
+			void update_incumbent(
+					double cost,
+					const Eigen::MatrixX<int>& region_assignments,
+					const SolvedTrajectory& trajectory
+					);
+	};
+} // namespace trajopt
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <Eigen/Core>
+#include <drake/solvers/mathematical_program.h>
+#include <drake/solvers/solve.h>
+
+namespace trajopt
+{
+	// Sequence of regions from a start to a goal point
+	struct RegionPath
+	{
+		std::vector<int> regions;
+		// Start point, the transition points between consecutive regions,
+		// and the goal point. Region k is entered at points[k] and left at points[k + 1].
+		std::vector<Eigen::VectorXd> points;
+		double length = 0;
+	};
+
+	// Overlap graph of convex regions A_r * x <= b_r.
+	// Two regions are neighbours if their intersection, shrunk by the margin,
+	// is nonempty, i.e. a trajectory can pass from one region to the other.
+	class RegionGraph
+	{
+		public:
+			RegionGraph(
+					std::vector<Eigen::MatrixXd> As,
+					std::vector<Eigen::VectorXd> bs,
+					double margin
+					);
+			// With the overlaps of a previous construction on the same regions,
+			// e.g. from the region graph cache, which skips the overlap LPs.
+			// edges[k] = (r1, r2) with r1 < r2 in ascending order, which
+			// overlap at transition_points[k].
+			RegionGraph(
+					std::vector<Eigen::MatrixXd> As,
+					std::vector<Eigen::VectorXd> bs,
+					double margin,
+					const std::vector<std::pair<int, int>>& edges,
+					const std::vector<Eigen::VectorXd>& transition_points
+					);
+
+			int get_num_regions() const { return num_regions_; };
+			int get_dim() const { return As_.empty() ? 0 : As_[0].cols(); };
+			double get_margin() const { return margin_; };
+			bool are_neighbours(int r1, int r2) const;
+			// Does not include the region itself
+			const std::vector<int>& get_neighbours(int r) const;
+			// Regions containing the point with the margin
+			std::vector<int> get_regions_containing(const Eigen::VectorXd& point) const;
+			// Number of region transitions needed to reach each region from
+			// any of the sources, or -1 if unreachable
+			std::vector<int> get_distances(const std::vector<int>& sources) const;
+			// Center of the intersection of two neighbouring regions
+			const Eigen::VectorXd& get_transition_point(int r1, int r2) const;
+			// A* search for the shortest polyline from start to goal that only
+			// changes region at the transition points. Returns false if there is none.
+			bool find_shortest_path(
+					const Eigen::VectorXd& start,
+					const Eigen::VectorXd& goal,
+					RegionPath* path
+					) const;
+
+			// Rounds relaxed region weights (num_regions x num_segments) to the
+			// assignments with the largest total weight, such that consecutive
+			// segments are in the same or neighbouring regions and the first and
+			// last segment contain the start and the goal. Where the highest weight
+			// region of each segment satisfies this, it is chosen.
+			// Returns an empty matrix if there is no such assignment.
+			Eigen::MatrixX<int> round_region_weights(
+					const Eigen::MatrixXd& weights,
+					const Eigen::VectorXd& start,
+					const Eigen::VectorXd& goal
+					) const;
+
+		private:
+			const int num_regions_;
+			const double margin_;
+			const std::vector<Eigen::MatrixXd> As_;
+			const std::vector<Eigen::VectorXd> bs_;
+			std::vector<std::vector<int>> neighbours_;
+			// transition_points_[r][k] belongs to neighbours_[r][k]
+			std::vector<std::vector<Eigen::VectorXd>> transition_points_;
+
+			bool regions_intersect(int r1, int r2, Eigen::VectorXd* point) const;
+	};
+
+	// Distributes the segments over the regions of a path, in proportion to the
+	// path length in each region and with at least one segment per region.
+	// Returns an empty matrix if there are fewer segments than regions.
+	Eigen::MatrixX<int> get_region_assignments_along_path(
+			const RegionPath& path, int num_regions, int num_traj_segments
+			);
+} // namespace trajopt
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+
+#include "trajopt/region_graph.h"
+
+namespace trajopt
+{
+	// On-disk cache of the region overlap graph, which needs one LP per pair of
+	// regions and dominates the startup time of a planner. There is one file
+	// per set of regions in the cache directory, named by the hash of the
+	// region data. The assembled MISOSProblem matrices are not cached: they
+	// come from the precomputed MISOSBlocks tables, and every program has to
+	// be rebuilt through Drake's Add* calls anyway.
+	// The file is a flat binary image, which is mapped into memory, checked
+	// and copied into the RegionGraph:
+	//   header        RegionGraphCacheHeader
+	//   edges         int32_t[2 * num_edges], (r1, r2) with r1 < r2
+	//   padding       to a multiple of 8 bytes
+	//   points        double[dim * num_edges], the transition point of each edge
+	// in the byte order of the machine that wrote it.
+	struct RegionGraphCacheHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t dim;
+		uint64_t key;
+		int32_t num_regions;
+		int32_t num_edges;
+	};
+
+	// FNV-1a hash of the region halfspaces, their sizes and the margin
+	uint64_t hash_regions(
+			const std::vector<Eigen::MatrixXd>& As,
+			const std::vector<Eigen::VectorXd>& bs,
+			double margin
+			);
+
+	// Returns false if the file does not exist, or was written for other regions
+	bool read_region_graph(
+			const std::string& path,
+			const std::vector<Eigen::MatrixXd>& As,
+			const std::vector<Eigen::VectorXd>& bs,
+			double margin,
+			std::shared_ptr<const RegionGraph>* region_graph
+			);
+	// Writes to a temporary file that is renamed into place, such that
+	// concurrent readers never see a partial file
+	bool write_region_graph(
+			const std::string& path,
+			uint64_t key,
+			const RegionGraph& region_graph
+			);
+
+	// Loads the graph from the cache directory, or builds it and stores it
+	// there. Always builds the graph if cache_dir is empty.
+	std::shared_ptr<const RegionGraph> load_or_build_region_graph(
+			const std::vector<Eigen::MatrixXd>& As,
+			const std::vector<Eigen::VectorXd>& bs,
+			double margin,
+			const std::string& cache_dir
+			);
+} // namespace trajopt
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace trajopt
+{
+	// Smallest big M for each halfspace a_i^T x <= b_i - radius, such that
+	// big_M_i + b_i - radius - a_i^T x >= 0 for all x in the box [lower, upper],
+	// i.e. max_{x in box} a_i^T x - b_i + radius (and at least zero)
+	Eigen::VectorXd calc_tight_big_M(
+			const Eigen::MatrixXd& A,
+			const Eigen::VectorXd& b,
+			const Eigen::VectorXd& lower,
+			const Eigen::VectorXd& upper,
+			double radius
+			);
+
+	// Scales each row of A x <= b such that ||a_i|| = 1, which makes the
+	// vehicle radius a distance in every halfspace
+	void normalize_halfspaces(Eigen::MatrixXd* A, Eigen::VectorXd* b);
+
+	// Rows of the normalized A x <= b that define a facet of the bounded
+	// polytope with the given vertices (e.g. from iris::Polyhedron::generatorPoints()).
+	// A row is a facet if its tight vertices span a hyperplane.
+	// Of several equal rows only the first is kept.
+	std::vector<int> find_nonredundant_halfspaces(
+			const Eigen::MatrixXd& A,
+			const Eigen::VectorXd& b,
+			const std::vector<Eigen::VectorXd>& vertices
+			);
+
+	// Normalizes A x <= b and removes all rows that are not facets
+	void remove_redundant_halfspaces(
+			const std::vector<Eigen::VectorXd>& vertices,
+			Eigen::MatrixXd* A, Eigen::VectorXd* b
+			);
+
+	// The 2 * dim facets of the box [lower, upper]
+	void get_box_halfspaces(
+			const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+			Eigen::MatrixXd* A, Eigen::VectorXd* b
+			);
+
+	// Removes the rows of the normalized A x <= b that coincide with a facet of
+	// the box [lower, upper]. The region is unchanged inside the box, so the box
+	// facets can be shared by all regions instead (MISOSProblem::add_shared_halfspaces).
+	void remove_box_facets(
+			const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+			Eigen::MatrixXd* A, Eigen::VectorXd* b
+			);
+} // namespace trajopt
@@ -2,6 +2,9 @@
 
 #include "iris/iris.h"
 #include <cmath>
+#include <iostream>
+
+#include "trajopt/region_tools.h"
 
 namespace trajopt
 {
@@ -27,10 +30,16 @@ namespace trajopt
 			void calc_safe_regions_from_seedpoints(
 					std::vector<Eigen::Vector3d> seedpoints
 					);
+			// Normalizes the halfspaces of all regions, and removes duplicated rows
+			// and rows that are not facets of the region, such as most of the bounds.
+			// Uses the vertices of the regions, and leaves the regions unchanged.
+			void remove_redundant_halfspaces();
 
 			std::vector<Eigen::MatrixXd> get_As() { return safe_region_As_; };
 			std::vector<Eigen::VectorXd> get_bs() { return safe_region_bs_; };
 			std::vector<iris::Polyhedron> get_polyhedrons() { return safe_regions_; };
+			Eigen::VectorXd get_bounds_lower();
+			Eigen::VectorXd get_bounds_upper();
 
 		private:
 			int num_dimensions_;
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+#include <Eigen/Core>
+
+#include "trajopt/SolvedTrajectory.h"
+
+namespace trajopt
+{
+	struct DynamicLimits
+	{
+		double max_velocity = 5.0;
+		// Maximum collective thrust divided by the vehicle mass [m/s^2]
+		double max_thrust_acceleration = 20.0;
+		// Acts along the last variable, only for 3D trajectories
+		double gravity = 9.81;
+	};
+
+	// Smallest factor alpha such that the trajectory slowed down by alpha,
+	// x(t / alpha), satisfies the limits at the sample times. The velocity scales
+	// with 1 / alpha and the acceleration with 1 / alpha^2, so alpha < 1 means
+	// the trajectory can be flown faster.
+	double calc_min_time_scaling(
+			const SolvedTrajectory& traj,
+			const DynamicLimits& limits,
+			int samples_per_segment
+			);
+
+	// x(t / alpha), with the breaks scaled by alpha
+	SolvedTrajectory scale_time(const SolvedTrajectory& traj, double alpha);
+
+	// Minimizes a unimodal function on [lower, upper], returns the best point
+	double golden_section_search(
+			const std::function<double(double)>& f,
+			double lower, double upper, int num_iterations
+			);
+} // namespace trajopt
@@ -317,14 +317,17 @@ namespace controller
 	// Calculate full state trajectory from flat outputs
 	// Based on paper by Mellinger, Kumar (2011):
 	// "Minimum snap trajectory generation and control for quadrotors"
-	Eigen::VectorXd ControllerTVLQR::get_state_traj_from_flat_outputs(trajopt::MISOSProblem *traj_obj, double t)
+	// Uses sample s of the flat outputs and their first four derivatives
+	Eigen::VectorXd ControllerTVLQR::get_state_traj_from_flat_outputs(
+			const trajopt::TrajectorySamples& flat_outputs, int s
+			)
 	{
 		double yaw = 0;
-		Eigen::Vector3d r = traj_obj->eval(t);
-		Eigen::Vector3d r_Dt = traj_obj->eval_derivative(t,1);
-		Eigen::Vector3d a = traj_obj->eval_derivative(t,2);
-		Eigen::Vector3d a_Dt = traj_obj->eval_derivative(t,3);
-		Eigen::Vector3d a_DDt = traj_obj->eval_derivative(t,4);
+		Eigen::Vector3d r = flat_outputs.get_sample(0, s);
+		Eigen::Vector3d r_Dt = flat_outputs.get_sample(1, s);
+		Eigen::Vector3d a = flat_outputs.get_sample(2, s);
+		Eigen::Vector3d a_Dt = flat_outputs.get_sample(3, s);
+		Eigen::Vector3d a_DDt = flat_outputs.get_sample(4, s);
 
 		double u_thrust = get_u_thrust_from_traj(a);
 		Eigen::Vector3d rpy = get_rpy_from_traj(r, a, yaw);
@@ -371,26 +374,29 @@ namespace controller
 
 	std::unique_ptr<DrakeControllerTVLQR> ControllerTVLQR::construct_drake_controller(
 			double dt,
-			trajopt::MISOSProblem* traj_obj
+			const trajopt::SolvedTrajectory& traj
 			)
 	{
 		double hover_thrust = m_ * g_;
 
 		dt_ = dt;
-		end_time_ = traj_obj->get_end_time();
+		end_time_ = traj.get_end_time();
 		N_ = end_time_ / dt_;
 
 		// *******
 		// Calculate full state trajectory from flat outpus
 		// *******
 
+		// Sample the flat outputs at all knots in one batch
+		Eigen::VectorXd knot_times(N_);
+		for (int i = 0; i < N_; ++i)
+			knot_times(i) = (i + 1) * dt;
+		trajopt::TrajectorySamples flat_outputs(3, 4, N_);
+		traj.eval_batch(knot_times, &flat_outputs);
+
 		Eigen::VectorX<Eigen::VectorXd> full_state_traj(N_);
-		double t = 0;
 		for (int i = 0; i < N_; ++i)
-		{
-			t += dt;
-			full_state_traj(i) = get_state_traj_from_flat_outputs(traj_obj, t);
-		}
+			full_state_traj(i) = get_state_traj_from_flat_outputs(flat_outputs, i);
 
 		// ******
 		// Calculate linearizations A, B
@@ -399,7 +405,7 @@ namespace controller
 		Eigen::VectorX<Eigen::MatrixXd> As(N_);
 		Eigen::VectorX<Eigen::MatrixXd> Bs(N_);
 	
-		t = 0;
+		double t = 0;
 		drake::symbolic::Environment curr_state;
 		for (int i = 0; i < N_; ++i)
 		{
@@ -1,4 +1,5 @@
 #include "test/tests.h"
+#include "test/benchmarks.h"
 #include "simulate/simulate.h"
 
 int main(int argc, char* argv[])
@@ -6,6 +7,15 @@ int main(int argc, char* argv[])
 	//test_trajectory_socp_fix_mi_variables();
 	simulate();
 	//test_iris3d();
+	//benchmark_misos_construction();
+	//benchmark_big_M();
+	//benchmark_region_formulations();
+	//benchmark_redundant_halfspaces();
+	//benchmark_symmetry_breaking();
+	//benchmark_solver_backends();
+	//benchmark_batch_planning();
+	//benchmark_replanning();
+	//benchmark_region_graph_cache();
 
 	return 0;
 }
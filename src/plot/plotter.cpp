@@ -1,33 +1,34 @@
 #include "plot/plotter.h"
 
 // Plots a trajectory in 2D. Will disregard z component
-void plot_MISOSTrajectory(
-		trajopt::MISOSProblem *traj, int num_traj_segments, Eigen::VectorX<double> init_pos, Eigen::VectorX<double> final_pos
+void plot_traj(
+		const trajopt::SolvedTrajectory& traj, Eigen::VectorX<double> init_pos, Eigen::VectorX<double> final_pos
 		)
 {
-	int tf = num_traj_segments;
+	const double t0 = traj.get_start_time();
+	const double tf = traj.get_end_time();
 
 	// Plot trajectory
 	const double delta_t = 0.01;
-	int N = (int)(tf / delta_t);
+	int N = (int)((tf - t0) / delta_t);
 
 	std::vector<double> x;
 	std::vector<double> y;
 
 	for (int i = 0; i < N; ++i)
 	{
-		double t = 0.0 + delta_t * i;
-		x.push_back(traj->eval(t)(0));
-		y.push_back(traj->eval(t)(1));
+		double t = t0 + delta_t * i;
+		x.push_back(traj.eval(t)(0));
+		y.push_back(traj.eval(t)(1));
 	}
 
 	// Plot segment start and ends
 	std::vector<double> sample_times_x;
 	std::vector<double> sample_times_y;
-	for (int t = 0; t <= num_traj_segments; ++t)
+	for (double t : traj.get_breaks())
 	{
-			sample_times_x.push_back(traj->eval(t)(0));
-			sample_times_y.push_back(traj->eval(t)(1));
+			sample_times_x.push_back(traj.eval(t)(0));
+			sample_times_y.push_back(traj.eval(t)(1));
 	}
 
 
@@ -66,7 +67,7 @@ void plot_2d_region(std::vector<Eigen::VectorXd> points, bool filled)
 	std::vector<double> x;
 	std::vector<double> y;
 
-	for (int i = 0; i < points.size(); ++i)
+	for (int i = 0; i < (int) points.size(); ++i)
 	{	
 		x.push_back(points[i](0));
 		y.push_back(points[i](1));
@@ -85,7 +86,7 @@ void plot_2d_region(std::vector<Eigen::VectorXd> points, bool filled)
 // Obstacle: (x,y)
 void plot_2d_obstacles(std::vector<Eigen::MatrixXd> obstacles)
 {
-	for (int i = 0; i < obstacles.size(); ++i)
+	for (int i = 0; i < (int) obstacles.size(); ++i)
 	{
 		std::vector<double> x;
 		std::vector<double> y;
@@ -107,7 +108,7 @@ void plot_3d_obstacles_footprints(
 {
 	bool show = false;
 	// Plot convex regions
-	for (int i = 0; i < obstacles.size(); ++i)
+	for (int i = 0; i < (int) obstacles.size(); ++i)
 	{
 		auto obstacle = obstacles[i];
 		std::vector<Eigen::VectorXd> ground_points;
@@ -128,7 +129,7 @@ void plot_3d_regions_footprint(
 		)
 {
 	// Plot convex regions
-	for (int i = 0; i < convex_polygons.size(); ++i)
+	for (int i = 0; i < (int) convex_polygons.size(); ++i)
 	{
 		std::vector<Eigen::VectorXd> ground_points;
 		auto temp = convex_polygons[i].generatorPoints();
@@ -138,7 +139,7 @@ void plot_3d_regions_footprint(
 				ground_points.push_back((Eigen::VectorXd(2) << point(0), point(1)).finished());
 		}
 		bool show = false;
-		if (i == convex_polygons.size() - 1) show = true;
+		if (i == (int) convex_polygons.size() - 1) show = true;
 		if (ground_points.size() > 0)
 			plot_2d_convex_hull(ground_points, false, show);
 		else
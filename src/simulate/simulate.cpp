@@ -71,7 +71,7 @@ void DrakeSimulation::retrieve_obstacles()
 	obstacles_ = geometry::getObstaclesVertices(&query_object, &inspector, obstacle_geometries);
 }
 
-void DrakeSimulation::add_controller_tvlqr(trajopt::MISOSProblem* traj)
+void DrakeSimulation::add_controller_tvlqr(const trajopt::SolvedTrajectory& traj)
 {
 	auto tvlqr_constructor =
 		controller::ControllerTVLQR(m_, arm_length_, inertia_, k_f_, k_m_);
@@ -111,7 +111,9 @@ void DrakeSimulation::run_simulation(Eigen::VectorXd x0)
 	simulator.AdvanceTo(FLAGS_simulation_time); // seconds
 }
 
-void DrakeSimulation::calculate_safe_regions(int num_safe_regions)
+void DrakeSimulation::calculate_safe_regions(
+		int num_safe_regions, bool plot, bool remove_redundant_halfspaces
+		)
 {
 	// Get convex safe regions
 	trajopt::SafeRegions safe_regions(3);
@@ -120,8 +122,14 @@ void DrakeSimulation::calculate_safe_regions(int num_safe_regions)
 	//simple: safe_regions.set_bounds(-5, 5, -2.5, 12.5, 0, 2); // Matches 'ground' object in obstacles.urdf
 	safe_regions.set_obstacles(obstacles_);
 	safe_regions.calc_safe_regions_auto(num_safe_regions);
+	if (remove_redundant_halfspaces)
+		safe_regions.remove_redundant_halfspaces();
 	safe_region_As_ = safe_regions.get_As();
 	safe_region_bs_ = safe_regions.get_bs();
+	workspace_lower_ = safe_regions.get_bounds_lower();
+	workspace_upper_ = safe_regions.get_bounds_upper();
+
+	if (!plot) return;
 
 	// TODO hardcoded in bottom and top for plot
 	plot_3d_obstacles_footprints(obstacles_, 0);
@@ -183,25 +191,21 @@ void simulate()
 	std::cout << "Calculated safe regions" << std::endl;
 	auto safe_regions_As = obst_sim.get_safe_regions_As();
 	auto safe_regions_bs = obst_sim.get_safe_regions_bs();
+	auto workspace_lower = obst_sim.get_workspace_lower();
+	auto workspace_upper = obst_sim.get_workspace_upper();
 
-	// Calculate trajectory
-	int num_vars = 3;
-	int num_traj_segments = 15;
-	int degree = 5;
-	int cont_degree = 4;
-
-	auto traj = trajopt::MISOSProblem(
-			num_traj_segments, num_vars, degree, cont_degree, init_pos, final_pos
-			);
+	// Calculate trajectory with as few segments as possible
+	int max_num_traj_segments = 15;
 
-	find_trajectory(
-			init_pos, final_pos, num_traj_segments, safe_regions_As, safe_regions_bs, &traj
+	trajopt::SolvedTrajectory traj = find_trajectory(
+			init_pos, final_pos, max_num_traj_segments, safe_regions_As, safe_regions_bs,
+			workspace_lower, workspace_upper
 			);
 
 	std::cout << "Trajectory found. Press any key to simulate\n";
 	system("read");
 
-	publish_traj_to_visualizer(&traj);
+	publish_traj_to_visualizer(traj);
 
 	// Initial conditions
 	Eigen::VectorX<double> x0 = Eigen::VectorX<double>::Zero(12);
@@ -214,7 +218,7 @@ void simulate()
 	auto sim = DrakeSimulation(
 			m, arm_length, inertia, k_f_, k_m_, obstacle_model_path
 			);
-	sim.add_controller_tvlqr(&traj);
+	sim.add_controller_tvlqr(traj);
 	sim.connect_to_drake_visualizer();
 	sim.build_quadrotor_diagram();
 	std::cout << "Running drake simulation" << std::endl;
@@ -222,42 +226,52 @@ void simulate()
 		sim.run_simulation(x0);
 }
 
-void find_trajectory(
+// The mathematical programs only live inside this function,
+// only the solved trajectory is returned
+trajopt::SolvedTrajectory find_trajectory(
 		Eigen::Vector3d init_pos,
 		Eigen::Vector3d final_pos,
-		int num_traj_segments,
+		int max_num_traj_segments,
 		std::vector<Eigen::MatrixXd> safe_region_As,
 		std::vector<Eigen::VectorXd> safe_region_bs,
-		trajopt::MISOSProblem* traj
+		Eigen::VectorXd workspace_lower,
+		Eigen::VectorXd workspace_upper
 		)
 {
-	auto traj_3rd_deg = trajopt::MISOSProblem(
-			num_traj_segments, 3, 3, 2, init_pos, final_pos
-			);
-
-	traj_3rd_deg.add_convex_regions(safe_region_As, safe_region_bs);
-	traj_3rd_deg.create_region_binary_variables();
-	traj_3rd_deg.generate();
-	Eigen::MatrixX<int> safe_region_assignments = traj_3rd_deg.get_region_assignments();
-	std::cout << "Found 3rd order trajectory" << std::endl;
-
-	// Create trajectory with degree 5 with fixed region constraints
-	traj->add_convex_regions(safe_region_As, safe_region_bs);
-	traj->add_safe_region_assignments(safe_region_assignments);
-	traj->generate();
-	std::cout << "Found 5th order trajectory" << std::endl;
+	trajopt::Planner planner(safe_region_As, safe_region_bs);
+	planner.set_workspace_bounds(workspace_lower, workspace_upper);
+	trajopt::PlanResult result =
+		planner.plan_auto_segments(init_pos, final_pos, max_num_traj_segments);
+	if (result.status == trajopt::PlanStatus::kFailed)
+	{
+		std::cerr << "Found no trajectory with up to " << max_num_traj_segments
+			<< " segments. " << result.timings << std::endl;
+		std::exit(EXIT_FAILURE);
+	}
+	std::cout << "Found trajectory with " << result.trajectory.get_num_segments()
+		<< " segments (" << result.status << "). "
+		<< result.timings << std::endl;
+
+	return result.trajectory;
 }
 
 // TODO replace num_traj_segments w end time
-void publish_traj_to_visualizer(trajopt::MISOSProblem* traj)
+void publish_traj_to_visualizer(const trajopt::SolvedTrajectory& traj)
 {
-	double end_time = traj->get_end_time();
+	double end_time = traj.get_end_time();
+	const int num_samples = std::ceil(end_time / 0.1);
+	Eigen::VectorXd times = Eigen::VectorXd::LinSpaced(
+			num_samples, 0.0, 0.1 * (num_samples - 1)
+			);
+	trajopt::TrajectorySamples positions(3, 0, num_samples);
+	traj.eval_batch(times, &positions);
+
   std::vector<std::string> names;
   std::vector<Eigen::Isometry3d> poses;
-  for (double t = 0.0; t < end_time; t += 0.1) {
-    names.push_back("X" + std::to_string(int(t * 100)));
+  for (int s = 0; s < num_samples; ++s) {
+    names.push_back("X" + std::to_string(int(times(s) * 100)));
     Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
-    pose.translation() = traj->eval(t);
+    pose.translation() = positions.get_sample(0, s);
     poses.push_back(pose);
   }
 
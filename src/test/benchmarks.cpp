@@ -0,0 +1,646 @@
+#include "test/benchmarks.h"
+
+// Creates a corridor of overlapping boxes along the x-axis,
+// with the same halfspace representation as IRIS regions
+void make_box_corridor(
+		int num_regions,
+		std::vector<Eigen::MatrixXd>* As,
+		std::vector<Eigen::VectorXd>* bs
+		)
+{
+	Eigen::MatrixXd A(6,3);
+	A << -1, 0, 0,
+				0, -1, 0,
+				0, 0, -1,
+				1, 0, 0,
+				0, 1, 0,
+				0, 0, 1;
+
+	for (int r = 0; r < num_regions; ++r)
+	{
+		Eigen::VectorXd b(6);
+		b << -r, 1, 0,
+				 r + 1.5, 1, 2;
+		As->push_back(A);
+		bs->push_back(b);
+	}
+}
+
+// Measures the time it takes to build the full mixed-integer program
+// (no solve) for a range of segment and region counts
+void benchmark_misos_construction()
+{
+	const int num_vars = 3;
+	const int num_repetitions = 3;
+	std::vector<int> degrees = { 3, 5 };
+	std::vector<int> segment_counts = { 5, 10, 15, 20 };
+	std::vector<int> region_counts = { 4, 8, 12 };
+
+	std::cout << "degree, segments, regions, construction time [ms]" << std::endl;
+	for (int degree : degrees)
+		for (int num_traj_segments : segment_counts)
+			for (int num_regions : region_counts)
+			{
+				std::vector<Eigen::MatrixXd> As;
+				std::vector<Eigen::VectorXd> bs;
+				make_box_corridor(num_regions, &As, &bs);
+
+				Eigen::VectorX<double> init_pos(num_vars);
+				init_pos << 0.5, 0, 1;
+				Eigen::VectorX<double> final_pos(num_vars);
+				final_pos << num_regions, 0, 1;
+
+				double total_ms = 0;
+				for (int rep = 0; rep < num_repetitions; ++rep)
+				{
+					auto start = std::chrono::high_resolution_clock::now();
+
+					auto traj = trajopt::MISOSProblem(
+							num_traj_segments, num_vars, degree, degree - 1, init_pos, final_pos
+							);
+					traj.add_convex_regions(As, bs);
+					traj.create_region_binary_variables();
+
+					auto end = std::chrono::high_resolution_clock::now();
+					total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+				}
+
+				std::cout << degree << ", " << num_traj_segments << ", "
+					<< num_regions << ", " << total_ms / num_repetitions << std::endl;
+			}
+}
+
+// Compares sampling a degree 5 trajectory through drake::symbolic polynomials
+// with sampling the numeric SolvedTrajectory
+void benchmark_trajectory_sampling()
+{
+	const int num_vars = 3;
+	const int degree = 5;
+	const int num_traj_segments = 15;
+	const double dt = 0.001;
+	const int N = num_traj_segments / dt;
+
+	std::vector<Eigen::MatrixXd> segment_coeffs;
+	for (int j = 0; j < num_traj_segments; ++j)
+		segment_coeffs.push_back(Eigen::MatrixXd::Random(num_vars, degree + 1));
+	trajopt::SolvedTrajectory traj(segment_coeffs);
+
+	// Symbolic reference, as used by MISOSProblem::eval before
+	drake::symbolic::Variable t_var("t");
+	Eigen::VectorX<drake::symbolic::Expression> m(degree + 1);
+	for (int d = 0; d < degree + 1; ++d)
+		m(d) = drake::symbolic::Monomial(t_var, d).ToExpression();
+
+	Eigen::MatrixX<drake::symbolic::Polynomial> polynomials(num_vars, num_traj_segments);
+	for (int j = 0; j < num_traj_segments; ++j)
+	{
+		Eigen::VectorX<drake::symbolic::Expression> expr =
+			segment_coeffs[j].cast<drake::symbolic::Expression>() * m;
+		for (int i = 0; i < num_vars; ++i)
+			polynomials(i,j) = drake::symbolic::Polynomial(expr(i));
+	}
+
+	double checksum = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int k = 0; k < N; ++k)
+	{
+		double t = k * dt;
+		int j = std::min((int) t, num_traj_segments - 1);
+		drake::symbolic::Environment at_t {{t_var, t - j}};
+		for (int i = 0; i < num_vars; ++i)
+			checksum += polynomials(i,j).Evaluate(at_t);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	double symbolic_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int k = 0; k < N; ++k)
+		checksum -= traj.eval(k * dt).sum();
+	end = std::chrono::high_resolution_clock::now();
+	double numeric_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// All derivatives at once, as used by the TVLQR controller
+	Eigen::MatrixXd derivatives(num_vars, degree + 1);
+	start = std::chrono::high_resolution_clock::now();
+	for (int k = 0; k < N; ++k)
+		traj.eval_all_derivatives(k * dt, derivatives);
+	end = std::chrono::high_resolution_clock::now();
+	double all_derivatives_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// Batch evaluation into a structure-of-arrays buffer
+	Eigen::VectorXd times(N);
+	for (int k = 0; k < N; ++k)
+		times(k) = k * dt;
+	trajopt::TrajectorySamples samples(num_vars, degree, N);
+	start = std::chrono::high_resolution_clock::now();
+	traj.eval_batch(times, &samples);
+	end = std::chrono::high_resolution_clock::now();
+	double batch_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+	std::cout << "Samples: " << N << " (checksum " << checksum << ")" << std::endl;
+	std::cout << "Symbolic position [ms]: " << symbolic_ms << std::endl;
+	std::cout << "Numeric position [ms]: " << numeric_ms << std::endl;
+	std::cout << "Numeric all derivatives [ms]: " << all_derivatives_ms << std::endl;
+	std::cout << "Batch all derivatives [ms]: " << batch_ms << std::endl;
+	std::cout << "Speedup position: " << symbolic_ms / numeric_ms << std::endl;
+}
+
+// Safe regions of one obstacle scene, computed as in simulate()
+void calc_scene_regions(
+		const std::string& obstacle_model_path,
+		std::vector<Eigen::MatrixXd>* As,
+		std::vector<Eigen::VectorXd>* bs,
+		Eigen::VectorXd* workspace_lower,
+		Eigen::VectorXd* workspace_upper
+		)
+{
+	calc_scene_regions(
+			obstacle_model_path, true, As, bs, workspace_lower, workspace_upper
+			);
+}
+
+void calc_scene_regions(
+		const std::string& obstacle_model_path,
+		bool remove_redundant_halfspaces,
+		std::vector<Eigen::MatrixXd>* As,
+		std::vector<Eigen::VectorXd>* bs,
+		Eigen::VectorXd* workspace_lower,
+		Eigen::VectorXd* workspace_upper
+		)
+{
+	// Skydio model
+	Eigen::Matrix3d inertia;
+	inertia << 0.0015, 0, 0,
+						 0, 0.0025, 0,
+						 0, 0, 0.0035;
+	double m = 0.775;
+	double arm_length = 0.15;
+	double k_f = 1.0;
+	double k_m = 0.0245;
+	const int num_safe_regions = 12;
+
+	auto sim = DrakeSimulation(m, arm_length, inertia, k_f, k_m, obstacle_model_path);
+	sim.build_quadrotor_diagram();
+	sim.retrieve_obstacles();
+	sim.calculate_safe_regions(num_safe_regions, false, remove_redundant_halfspaces);
+	*As = sim.get_safe_regions_As();
+	*bs = sim.get_safe_regions_bs();
+	*workspace_lower = sim.get_workspace_lower();
+	*workspace_upper = sim.get_workspace_upper();
+}
+
+// Compares the mixed-integer stage with the default big M and with the tight
+// big M per region halfspace, on the safe regions of each obstacle scene.
+// NOTE: Drake does not expose the Mosek branch-and-bound node count,
+// so only wall time and the average big M are reported.
+void benchmark_big_M()
+{
+	Eigen::Vector3d init_pos(-3.0, -1, 1.0);
+	Eigen::Vector3d final_pos(3.0, 11.5, 1.0);
+	const int num_traj_segments = 15;
+
+	std::vector<std::string> rows;
+	for (const auto& scene : kObstacleScenes)
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		Eigen::VectorXd lower, upper;
+		calc_scene_regions(scene, &As, &bs, &lower, &upper);
+
+		double sum_big_M = 0;
+		int num_halfspaces = 0;
+		for (int r = 0; r < (int) As.size(); ++r)
+		{
+			sum_big_M += trajopt::calc_tight_big_M(
+					As[r], bs[r], lower, upper, trajopt::kVehicleRadius
+					).sum();
+			num_halfspaces += As[r].rows();
+		}
+
+		std::stringstream row;
+		row << scene << ", " << sum_big_M / num_halfspaces;
+		for (bool use_tight_big_M : { false, true })
+		{
+			trajopt::PlannerOptions options;
+			options.use_tight_big_M = use_tight_big_M;
+			options.use_graph_seed = false;
+			trajopt::Planner planner(As, bs, options);
+			planner.set_workspace_bounds(lower, upper);
+			auto result = planner.plan(init_pos, final_pos, num_traj_segments);
+			row << ", " << result.timings.mip_solve;
+		}
+		rows.push_back(row.str());
+	}
+
+	// Printed last, as the solver output is interleaved with the runs
+	std::cout << "scene, average tight big M, MIP solve default big M [ms], "
+		<< "MIP solve tight big M [ms]" << std::endl;
+	for (const auto& row : rows)
+		std::cout << row << std::endl;
+}
+
+// Compares the big M and the convex hull formulation of the region binaries
+// on the mixed-integer stage of each obstacle scene. The root gap is
+// (MIP cost - root relaxation cost) / MIP cost.
+// NOTE: Drake does not expose the Mosek branch-and-bound node count.
+void benchmark_region_formulations()
+{
+	const int num_vars = 3;
+	const int degree = 3;
+	const int continuity_degree = 2;
+	const int num_traj_segments = 15;
+	Eigen::VectorXd init_pos(num_vars);
+	init_pos << -3.0, -1, 1.0;
+	Eigen::VectorXd final_pos(num_vars);
+	final_pos << 3.0, 11.5, 1.0;
+
+	std::vector<std::pair<std::string, trajopt::RegionFormulation>> formulations = {
+		{ "big M", trajopt::RegionFormulation::kBigM },
+		{ "convex hull", trajopt::RegionFormulation::kConvexHull }
+	};
+
+	std::vector<std::string> rows;
+	for (const auto& scene : kObstacleScenes)
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		Eigen::VectorXd lower, upper;
+		calc_scene_regions(scene, &As, &bs, &lower, &upper);
+		trajopt::RegionGraph region_graph(As, bs, trajopt::kVehicleRadius);
+
+		for (const auto& formulation : formulations)
+		{
+			double cost[2];
+			double solve_ms[2];
+			for (bool relax_binaries : { true, false })
+			{
+				trajopt::MISOSProblem prog(
+						num_traj_segments, num_vars, degree, continuity_degree,
+						init_pos, final_pos
+						);
+				prog.set_region_formulation(formulation.second);
+				prog.add_convex_regions(As, bs);
+				prog.set_workspace_bounds(lower, upper);
+				prog.add_region_graph(&region_graph);
+				prog.create_region_binary_variables(relax_binaries);
+
+				auto start = std::chrono::high_resolution_clock::now();
+				prog.generate();
+				solve_ms[relax_binaries] = trajopt::elapsed_ms(start);
+				cost[relax_binaries] = prog.get_cost();
+			}
+
+			std::stringstream row;
+			row << scene << ", " << formulation.first << ", "
+				<< (cost[0] - cost[1]) / cost[0] << ", "
+				<< solve_ms[1] << ", " << solve_ms[0];
+			rows.push_back(row.str());
+		}
+	}
+
+	// Printed last, as the solver output is interleaved with the runs
+	std::cout << "scene, formulation, root gap, root solve [ms], MIP solve [ms]"
+		<< std::endl;
+	for (const auto& row : rows)
+		std::cout << row << std::endl;
+}
+
+// Compares the mixed-integer stage on the IRIS regions as returned, with the
+// redundant halfspaces removed, and with the bounds facets also shared by all
+// regions, on the safe regions of each obstacle scene
+void benchmark_redundant_halfspaces()
+{
+	Eigen::Vector3d init_pos(-3.0, -1, 1.0);
+	Eigen::Vector3d final_pos(3.0, 11.5, 1.0);
+	const int num_traj_segments = 15;
+
+	std::vector<std::string> rows;
+	for (const auto& scene : kObstacleScenes)
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		Eigen::VectorXd lower, upper;
+		calc_scene_regions(scene, false, &As, &bs, &lower, &upper);
+
+		std::vector<Eigen::MatrixXd> reduced_As = As;
+		std::vector<Eigen::VectorXd> reduced_bs = bs;
+		int num_facets[3] = { 0, 0, (int) lower.size() * 2 };
+		for (int r = 0; r < (int) As.size(); ++r)
+		{
+			trajopt::remove_redundant_halfspaces(
+					iris::Polyhedron(As[r], bs[r]).generatorPoints(),
+					&reduced_As[r], &reduced_bs[r]
+					);
+			Eigen::MatrixXd A = reduced_As[r];
+			Eigen::VectorXd b = reduced_bs[r];
+			trajopt::remove_box_facets(lower, upper, &A, &b);
+
+			num_facets[0] += As[r].rows();
+			num_facets[1] += reduced_As[r].rows();
+			num_facets[2] += A.rows();
+		}
+
+		for (int variant = 0; variant < 3; ++variant)
+		{
+			trajopt::PlannerOptions options;
+			options.use_graph_seed = false;
+			options.share_bounds_facets = variant == 2;
+			trajopt::Planner planner(
+					variant == 0 ? As : reduced_As, variant == 0 ? bs : reduced_bs, options
+					);
+			planner.set_workspace_bounds(lower, upper);
+			auto result = planner.plan(init_pos, final_pos, num_traj_segments);
+
+			std::stringstream row;
+			row << scene << ", " << variant << ", " << num_facets[variant] << ", "
+				<< result.timings.mip_build << ", " << result.timings.mip_solve;
+			rows.push_back(row.str());
+		}
+	}
+
+	// Printed last, as the solver output is interleaved with the runs
+	std::cout << "variant 0: IRIS regions, 1: redundant halfspaces removed, "
+		<< "2: bounds facets shared" << std::endl;
+	std::cout << "scene, variant, halfspaces, MIP build [ms], MIP solve [ms]"
+		<< std::endl;
+	for (const auto& row : rows)
+		std::cout << row << std::endl;
+}
+
+// Compares the mixed-integer stage without and with the symmetry breaking
+// cuts on the region binaries, on the safe regions of each obstacle scene.
+// NOTE: Drake does not expose the Mosek branch-and-bound node count,
+// so only wall time is reported.
+void benchmark_symmetry_breaking()
+{
+	Eigen::Vector3d init_pos(-3.0, -1, 1.0);
+	Eigen::Vector3d final_pos(3.0, 11.5, 1.0);
+	const int num_traj_segments = 15;
+
+	std::vector<std::pair<bool, bool>> cuts = {
+		{ false, false }, { true, false }, { false, true }, { true, true }
+	};
+
+	std::vector<std::string> rows;
+	for (const auto& scene : kObstacleScenes)
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		Eigen::VectorXd lower, upper;
+		calc_scene_regions(scene, &As, &bs, &lower, &upper);
+
+		for (const auto& cut : cuts)
+		{
+			trajopt::PlannerOptions options;
+			options.use_graph_seed = false;
+			options.monotone_region_order = cut.first;
+			options.no_return_cuts = cut.second;
+			trajopt::Planner planner(As, bs, options);
+			planner.set_workspace_bounds(lower, upper);
+			auto result = planner.plan(init_pos, final_pos, num_traj_segments);
+
+			std::stringstream row;
+			row << scene << ", " << cut.first << ", " << cut.second << ", "
+				<< result.timings.mip_solve << ", " << result.status;
+			rows.push_back(row.str());
+		}
+	}
+
+	// Printed last, as the solver output is interleaved with the runs
+	std::cout << "scene, monotone region order, no return cuts, "
+		<< "MIP solve [ms], status" << std::endl;
+	for (const auto& row : rows)
+		std::cout << row << std::endl;
+}
+
+// Compares Mosek with Drake's branch-and-bound over SCS on the mixed-integer
+// stage of each obstacle scene, with the solver neutral statistics.
+// The branch-and-bound runs without a commercial solver license.
+void benchmark_solver_backends()
+{
+	const int num_vars = 3;
+	const int degree = 3;
+	const int continuity_degree = 2;
+	const int num_traj_segments = 8;
+	Eigen::VectorXd init_pos(num_vars);
+	init_pos << -3.0, -1, 1.0;
+	Eigen::VectorXd final_pos(num_vars);
+	final_pos << 3.0, 11.5, 1.0;
+
+	std::vector<std::string> rows;
+	for (const auto& scene : kObstacleScenes)
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		Eigen::VectorXd lower, upper;
+		calc_scene_regions(scene, &As, &bs, &lower, &upper);
+		trajopt::RegionGraph region_graph(As, bs, trajopt::kVehicleRadius);
+
+		for (bool branch_and_bound : { false, true })
+		{
+			trajopt::MISOSProblem prog(
+					num_traj_segments, num_vars, degree, continuity_degree,
+					init_pos, final_pos
+					);
+			if (branch_and_bound)
+				prog.set_branch_and_bound(drake::solvers::ScsSolver::id());
+			else
+				prog.set_solver_id(drake::solvers::MosekSolver::id());
+			prog.add_convex_regions(As, bs);
+			prog.set_workspace_bounds(lower, upper);
+			prog.add_region_graph(&region_graph);
+			prog.create_region_binary_variables();
+
+			trajopt::SolvedTrajectory traj;
+			prog.try_generate(&traj);
+			const auto& statistics = prog.get_solver_statistics();
+
+			std::stringstream row;
+			row << scene << ", " << statistics.solver_name << ", "
+				<< statistics.solve_status << ", " << statistics.cost << ", "
+				<< statistics.lower_bound << ", " << statistics.solve_time << ", "
+				<< statistics.num_nodes;
+			rows.push_back(row.str());
+		}
+	}
+
+	// Printed last, as the solver output is interleaved with the runs
+	std::cout << "scene, solver, status, cost, lower bound, solve time [s], nodes"
+		<< std::endl;
+	for (const auto& row : rows)
+		std::cout << row << std::endl;
+}
+
+// Plans random start and goal pairs through the safe regions of one scene,
+// once with a new planner per query as in find_trajectory(), and once as a
+// batch on a shared PlannerContext
+void benchmark_batch_planning()
+{
+	const int num_queries = 32;
+	std::vector<Eigen::MatrixXd> As;
+	std::vector<Eigen::VectorXd> bs;
+	Eigen::VectorXd lower, upper;
+	calc_scene_regions(kObstacleScenes[0], &As, &bs, &lower, &upper);
+	trajopt::RegionGraph region_graph(As, bs, trajopt::kVehicleRadius);
+
+	// Random points in the workspace that lie inside a safe region
+	std::srand(0);
+	auto random_safe_point = [&]()
+	{
+		while (true)
+		{
+			Eigen::VectorXd u = (Eigen::VectorXd::Random(lower.size()).array() + 1) / 2;
+			Eigen::VectorXd point = lower + (upper - lower).cwiseProduct(u);
+			if (!region_graph.get_regions_containing(point).empty())
+				return point;
+		}
+	};
+	std::vector<trajopt::PlanQuery> queries;
+	for (int q = 0; q < num_queries; ++q)
+		queries.push_back({ random_safe_point(), random_safe_point() });
+
+	trajopt::PlannerContextOptions context_options;
+	auto start = std::chrono::high_resolution_clock::now();
+	int num_failed_single = 0;
+	for (const auto& query : queries)
+	{
+		trajopt::Planner planner(As, bs);
+		planner.set_workspace_bounds(lower, upper);
+		trajopt::PlanResult result = planner.plan_auto_segments(
+				query.init_pos, query.final_pos, context_options.max_num_traj_segments
+				);
+		if (result.status == trajopt::PlanStatus::kFailed) ++num_failed_single;
+	}
+	const double single_ms = trajopt::elapsed_ms(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	trajopt::PlannerContext context(
+			As, bs, lower, upper, trajopt::PlannerOptions(), context_options
+			);
+	std::vector<trajopt::PlanResult> results = context.plan_batch(queries);
+	const double batch_ms = trajopt::elapsed_ms(start);
+
+	int num_failed_batch = 0;
+	double solve_ms = 0;
+	for (const auto& result : results)
+	{
+		if (result.status == trajopt::PlanStatus::kFailed) ++num_failed_batch;
+		solve_ms += result.timings.total;
+	}
+
+	std::cout << "Queries: " << num_queries << std::endl;
+	std::cout << "Planner per query [ms]: " << single_ms
+		<< " (" << num_failed_single << " failed)" << std::endl;
+	std::cout << "Batch [ms]: " << batch_ms
+		<< " (" << num_failed_batch << " failed)" << std::endl;
+	std::cout << "Batch summed query time [ms]: " << solve_ms << std::endl;
+	std::cout << "Speedup: " << single_ms / batch_ms << std::endl;
+}
+
+// Replans along a box corridor at 4 Hz, with the vehicle following the last
+// plan: once by updating the start of the same problem, and once by
+// building a new problem every cycle
+void benchmark_replanning()
+{
+	const int num_vars = 3;
+	const int degree = 3;
+	const int continuity_degree = 2;
+	const int num_traj_segments = 8;
+	const int num_regions = 6;
+	const int num_cycles = 8;
+	const double cycle_time = 0.25;
+
+	std::vector<Eigen::MatrixXd> As;
+	std::vector<Eigen::VectorXd> bs;
+	make_box_corridor(num_regions, &As, &bs);
+	trajopt::RegionGraph region_graph(As, bs, trajopt::kVehicleRadius);
+
+	Eigen::VectorX<double> init_pos(num_vars);
+	init_pos << 0.5, 0, 1;
+	Eigen::VectorX<double> final_pos(num_vars);
+	final_pos << num_regions, 0, 1;
+
+	auto make_problem = [&]()
+	{
+		auto prog = std::make_unique<trajopt::MISOSProblem>(
+				num_traj_segments, num_vars, degree, continuity_degree,
+				init_pos, final_pos
+				);
+		prog->add_convex_regions(As, bs);
+		prog->add_region_graph(&region_graph);
+		prog->set_replanning(true);
+		prog->create_region_binary_variables();
+		return prog;
+	};
+
+	std::unique_ptr<trajopt::MISOSProblem> prog = make_problem();
+	trajopt::SolvedTrajectory traj = prog->generate();
+
+	double replan_ms = 0;
+	double rebuild_ms = 0;
+	for (int cycle = 0; cycle < num_cycles; ++cycle)
+	{
+		// Position, velocity and acceleration after one cycle on the last plan
+		const Eigen::MatrixXd init_state =
+			traj.eval_all_derivatives(cycle_time).leftCols(3);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		std::unique_ptr<trajopt::MISOSProblem> rebuilt = make_problem();
+		rebuilt->update_initial_state(init_state);
+		trajopt::SolvedTrajectory rebuilt_traj;
+		rebuilt->try_generate(&rebuilt_traj);
+		rebuild_ms += trajopt::elapsed_ms(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		const bool success = prog->replan(init_state, cycle_time, &traj);
+		replan_ms += trajopt::elapsed_ms(start);
+		assert(success);
+
+		std::cout << "Cycle " << cycle << ": start " << init_state.col(0).transpose()
+			<< ", cost " << prog->get_cost() << " (rebuilt " << rebuilt->get_cost()
+			<< ")" << std::endl;
+	}
+
+	std::cout << "Rebuild per cycle [ms]: " << rebuild_ms / num_cycles << std::endl;
+	std::cout << "Replan per cycle [ms]: " << replan_ms / num_cycles << std::endl;
+	std::cout << "Speedup: " << rebuild_ms / replan_ms << std::endl;
+}
+
+// Compares building the region overlap graph of each obstacle scene
+// with loading it from the region graph cache
+void benchmark_region_graph_cache()
+{
+	const std::string cache_dir = std::filesystem::temp_directory_path().string();
+
+	std::cout << "scene, regions, build [ms], first call [ms], load [ms]"
+		<< std::endl;
+	for (const auto& scene : kObstacleScenes)
+	{
+		std::vector<Eigen::MatrixXd> As;
+		std::vector<Eigen::VectorXd> bs;
+		Eigen::VectorXd lower, upper;
+		calc_scene_regions(scene, &As, &bs, &lower, &upper);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		trajopt::RegionGraph built(As, bs, trajopt::kVehicleRadius);
+		const double build_ms = trajopt::elapsed_ms(start);
+
+		// The first call builds and writes the graph unless it is cached from an
+		// earlier run, the second one always loads it
+		start = std::chrono::high_resolution_clock::now();
+		trajopt::load_or_build_region_graph(As, bs, trajopt::kVehicleRadius, cache_dir);
+		const double write_ms = trajopt::elapsed_ms(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		auto loaded = trajopt::load_or_build_region_graph(
+				As, bs, trajopt::kVehicleRadius, cache_dir
+				);
+		const double load_ms = trajopt::elapsed_ms(start);
+
+		for (int r = 0; r < (int) As.size(); ++r)
+			assert(loaded->get_neighbours(r) == built.get_neighbours(r));
+
+		std::cout << scene << ", " << As.size() << ", " << build_ms << ", "
+			<< write_ms << ", " << load_ms << std::endl;
+	}
+}
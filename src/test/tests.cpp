@@ -68,7 +68,7 @@ void test_trajectory_socp_fix_mi_variables()
 
 	std::vector<iris::Polyhedron> convex_polygons;
 
-	for (int i = 0; i < seed_points.size(); ++i)
+	for (int i = 0; i < (int) seed_points.size(); ++i)
 	{
 		problem.setSeedPoint(seed_points[i]);
 		iris::IRISRegion region = inflate_region(problem, options);
@@ -77,7 +77,7 @@ void test_trajectory_socp_fix_mi_variables()
 
 	std::vector<Eigen::MatrixXd> As;
 	std::vector<Eigen::VectorXd> bs;
-	for (int i = 0; i < convex_polygons.size(); ++i)
+	for (int i = 0; i < (int) convex_polygons.size(); ++i)
 	{
 		// Matrix containing one convex region
 		As.push_back(convex_polygons[i].getA());
@@ -85,7 +85,7 @@ void test_trajectory_socp_fix_mi_variables()
 	}
 
 	// Plot convex regions
-	for (int i = 0; i < convex_polygons.size(); ++i)
+	for (int i = 0; i < (int) convex_polygons.size(); ++i)
 	{
 		auto points = convex_polygons[i].generatorPoints();
 		plot_2d_convex_hull(points);
@@ -118,12 +118,49 @@ void test_trajectory_socp_fix_mi_variables()
 	auto traj = trajopt::MISOSProblem(num_traj_segments, num_vars, degree, cont_degree, init_pos, final_pos);
 	traj.add_convex_regions(As, bs);
 	traj.add_safe_region_assignments(safe_region_assignments);
-	traj.generate();
-	plot_traj(&traj, num_traj_segments, init_pos, final_pos);
+	plot_traj(traj.generate(), init_pos, final_pos);
 	std::cout << "Found 5th order" << std::endl;
 }
 
 
+// Single stage mixed-integer problem at degree 5, with the segments
+// kept inside the regions through their Bernstein control points
+void test_trajectory_control_points()
+{
+	// L-shaped corridor made of three overlapping boxes
+	Eigen::MatrixXd A(4,2);
+	A << -1, 0,
+				0, -1,
+				1, 0,
+				0, 1;
+	std::vector<Eigen::MatrixXd> As = { A, A, A };
+	std::vector<Eigen::VectorXd> bs(3, Eigen::VectorXd(4));
+	bs[0] << 0, 0, 3, 1;
+	bs[1] << -2, 0, 3, 4;
+	bs[2] << -2, -3, 6, 4;
+
+	for (int r = 0; r < (int) As.size(); ++r)
+		plot_2d_convex_hull(iris::Polyhedron(As[r], bs[r]).generatorPoints());
+
+	int num_vars = 2;
+	int num_traj_segments = 6;
+	int degree = 5;
+	int cont_degree = 4;
+	Eigen::VectorX<double> init_pos(num_vars);
+	init_pos << 0.5, 0.5;
+
+	Eigen::VectorX<double> final_pos(num_vars);
+	final_pos << 5.5, 3.5;
+
+	auto traj = trajopt::MISOSProblem(num_traj_segments, num_vars, degree, cont_degree, init_pos, final_pos);
+	traj.set_region_containment(trajopt::RegionContainment::kControlPoints);
+	traj.add_convex_regions(As, bs);
+	traj.set_workspace_bounds(Eigen::Vector2d(0, 0), Eigen::Vector2d(6, 4));
+	traj.create_region_binary_variables();
+	plot_traj(traj.generate(), init_pos, final_pos);
+	std::cout << "Found 5th order in a single stage" << std::endl;
+}
+
 void test_trajopt()
 {
 	int num_vars = 2;
@@ -138,8 +175,7 @@ void test_trajopt()
 
 	auto traj = trajopt::MISOSProblem(num_traj_segments, num_vars, degree, cont_degree, init_pos, final_pos);
 
-	traj.generate();
-	plot_traj(&traj, num_traj_segments, init_pos, final_pos);
+	plot_traj(traj.generate(), init_pos, final_pos);
 }
 
 
@@ -213,7 +249,7 @@ void test_iris3d()
 		iris::IRISRegion region = inflate_region(problem, options);
 		convex_polygons.push_back(region.getPolyhedron());
 		auto vertices = region.getPolyhedron().generatorPoints();
-		for (int j = 0; j < vertices.size(); ++j)
+		for (int j = 0; j < (int) vertices.size(); ++j)
 		{
 			std::cout << vertices[j] << std::endl << std::endl;
 		}
@@ -288,7 +324,7 @@ void test_trajectory_with_iris()
 
 	std::vector<iris::Polyhedron> convex_polygons;
 
-	for (int i = 0; i < seed_points.size(); ++i)
+	for (int i = 0; i < (int) seed_points.size(); ++i)
 	{
 		problem.setSeedPoint(seed_points[i]);
 		iris::IRISRegion region = inflate_region(problem, options);
@@ -297,7 +333,7 @@ void test_trajectory_with_iris()
 
 	std::vector<Eigen::MatrixXd> As;
 	std::vector<Eigen::VectorXd> bs;
-	for (int i = 0; i < convex_polygons.size(); ++i)
+	for (int i = 0; i < (int) convex_polygons.size(); ++i)
 	{
 		// Matrix containing one convex region
 		As.push_back(convex_polygons[i].getA());
@@ -305,7 +341,7 @@ void test_trajectory_with_iris()
 	}
 
 	// Plot convex regions
-	for (int i = 0; i < convex_polygons.size(); ++i)
+	for (int i = 0; i < (int) convex_polygons.size(); ++i)
 	{
 		auto points = convex_polygons[i].generatorPoints();
 		plot_2d_convex_hull(points);
@@ -336,9 +372,7 @@ void test_trajectory_with_iris()
 	//traj.add_region_constraint(2, 5, true);
 	//traj.add_region_constraint(3, 6, true);
 	//traj.add_region_constraint(3, 7, true);
-	traj.generate();
-
-	plot_traj(&traj, num_traj_segments, init_pos, final_pos);
+	plot_traj(traj.generate(), init_pos, final_pos);
 }
 
 void test_iris()
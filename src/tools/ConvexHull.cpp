@@ -58,7 +58,7 @@ std::vector<Eigen::VectorXd> makeConvexHull(const std::vector<Eigen::VectorXd> p
 {
 	std::vector<Point> new_points;
 
-	for (int i = 0; i < points.size(); ++i)
+	for (int i = 0; i < (int) points.size(); ++i)
 	{
 		Point p = {
 			points[i](0),
@@ -72,7 +72,7 @@ std::vector<Eigen::VectorXd> makeConvexHull(const std::vector<Eigen::VectorXd> p
 	convex_hull = makeConvexHull(new_points);
 
 	std::vector<Eigen::VectorXd> new_convex_hull;
-	for (int i = 0; i < convex_hull.size(); ++i)
+	for (int i = 0; i < (int) convex_hull.size(); ++i)
 	{
 		Eigen::VectorXd v(2);
 		v(0) = convex_hull[i].x;
@@ -9,7 +9,7 @@ namespace geometry {
 		std::vector<const drake::multibody::Body<double>*> obstacle_bodies =
 			plant->GetBodiesWeldedTo(plant->GetBodyByName("ground"));
 		// Collect only obstacles
-		for (int i = 0; i < obstacle_bodies.size(); ++i)
+		for (int i = 0; i < (int) obstacle_bodies.size(); ++i)
 		{
 			if (obstacle_bodies[i]->name().find("obs") == std::string::npos)
 			{
@@ -20,11 +20,11 @@ namespace geometry {
 
 		// Collect all obstacle geometries
 		std::vector<drake::geometry::GeometryId> obstacle_geometries;
-		for (int i = 0; i < obstacle_bodies.size(); ++i)
+		for (int i = 0; i < (int) obstacle_bodies.size(); ++i)
 		{
 			const std::vector<drake::geometry::GeometryId>& obstacle_geometry =
 				plant->GetCollisionGeometriesForBody(*obstacle_bodies[i]);
-			for (int j = 0; j < obstacle_geometry.size(); ++j)
+			for (int j = 0; j < (int) obstacle_geometry.size(); ++j)
 			{
 				obstacle_geometries.push_back(obstacle_geometry[j]);
 			}
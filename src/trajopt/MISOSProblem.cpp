@@ -1,8 +1,35 @@
 #include "trajopt/MISOSProblem.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
 namespace trajopt
 {
 
+std::ostream& operator<<(std::ostream& os, const SolveStatus& status)
+{
+	switch (status)
+	{
+		case SolveStatus::kOptimal: os << "optimal"; break;
+		case SolveStatus::kFeasible: os << "feasible"; break;
+		case SolveStatus::kNoSolution: os << "no solution"; break;
+	}
+	return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const SolverStatistics& statistics)
+{
+	os << "solver: " << statistics.solver_name
+		<< ", status: " << statistics.solve_status
+		<< ", cost: " << statistics.cost
+		<< ", lower bound: " << statistics.lower_bound
+		<< ", solve time: " << statistics.solve_time << " s"
+		<< ", nodes: " << statistics.num_nodes;
+	return os;
+}
+
 MISOSProblem::MISOSProblem(
 		int num_traj_segments,
 		int num_vars,
@@ -11,126 +38,221 @@ MISOSProblem::MISOSProblem(
 		Eigen::VectorX<double> init_cond,
 		Eigen::VectorX<double> final_cond
 		) :
-	num_traj_segments_(num_traj_segments),
+	MISOSProblem(
+			num_traj_segments, num_vars, degree, continuity_degree,
+			init_cond, final_cond, std::vector<double>(num_traj_segments, 1.0)
+			)
+{}
+
+MISOSProblem::MISOSProblem(
+		int num_traj_segments,
+		int num_vars,
+		int degree,
+		int continuity_degree,
+		Eigen::VectorX<double> init_cond,
+		Eigen::VectorX<double> final_cond,
+		const std::vector<double>& segment_durations
+		) :
 	num_vars_(num_vars),
 	degree_(degree),
 	continuity_degree_(continuity_degree),
-	vehicle_radius_(0.2)
+	num_traj_segments_(num_traj_segments),
+	vehicle_radius_(kVehicleRadius),
+	init_cond_(init_cond),
+	final_cond_(final_cond),
+	segment_durations_(segment_durations)
 {
 	assert(continuity_degree_ <= degree_);
+	assert((int) segment_durations_.size() == num_traj_segments_);
 
 	t_ = prog_.NewIndeterminates(1, 1, "t")(0,0);
-	m_.resize(degree_ + 1); // Monomial basis
 
-	for (int d = 0; d < degree + 1; ++d)
-	{
-		m_(d) = drake::symbolic::Monomial(t_, d).ToExpression();
-	}
-
-	// Add coefficients
+	// Add d + 1 coefficients for each variable as decision variables
 	for (int j = 0;	j < num_traj_segments_; ++j)
+		coeffs_.push_back(prog_.NewContinuousVariables(num_vars, degree + 1, "C"));
+
+	dispatch_problem_size(degree_, num_vars_, [&](auto degree_c, auto dim_c)
 	{
-		// Add d + 1 coefficients for each variable as decision variables
-		coeff_matrix_t c = prog_.NewContinuousVariables(
-				num_vars, degree + 1, "C");
-		coeffs_.push_back(c);
-
-		// Calculate resulting coefficients for each derivative degree
-		std::vector<coeff_matrix_t> coeffs_dj;
-		for (int der_degree = 1; der_degree < degree_ + 1; ++der_degree)
-		{
-			// Calculate symbolic polynomials
-			auto p = c * m_; // vector of same size as problem
-			// Calculate coefficients of derivatives
-			auto px = drake::symbolic::Jacobian(p, {t_});
+		add_trajectory_constraints<decltype(degree_c)::value, decltype(dim_c)::value>(
+				init_cond, final_cond
+				);
+	});
+}
 
-			coeff_matrix_t c_d(num_vars_, degree_ + 1);
-			for (int i = 0; i < num_vars_; ++i)
-			{
-				auto coeff_map = drake::symbolic::Polynomial(px(i), {t_})
-					.monomial_to_coefficient_map();
+// All constraints below are linear in the coefficients, and are assembled
+// numerically from the monomial derivatives at the segment start and end.
+// Segment j is a polynomial in s = (t - t_j) / T_j on [0, 1], so the k-th time
+// derivative is the k-th derivative in s divided by T_j^k.
+template <int Degree, int Dim>
+void MISOSProblem::add_trajectory_constraints(
+		const Eigen::VectorX<double>& init_cond,
+		const Eigen::VectorX<double>& final_cond
+		)
+{
+	using Blocks = MISOSBlocks<Degree, Dim>;
 
-				for (int mm_deg = 0; mm_deg < degree_ + 1 - der_degree; ++mm_deg)
-					c_d(i, mm_deg) = coeff_map[drake::symbolic::Monomial(m_(mm_deg))];
-			}
-			coeffs_dj.push_back(c_d);
-			c = c_d;
-		}
-		coeffs_d_.push_back(coeffs_dj);
-	}
+	// Enforce continuity up to required continuity degree:
+	// [D(1) / T_j^k, -D(0) / T_j+1^k] * [c_j; c_j+1] = 0 for each variable.
+	// The constraints that depend on the segment durations are kept for
+	// update_segment_durations.
+	unit_continuity_A_ = Blocks::continuity_block(continuity_degree_);
+	const Eigen::VectorXd b_continuity = Eigen::VectorXd::Zero(continuity_degree_ + 1);
 
-	// Get symbolic expressions for monomial values at start and end
-	Eigen::VectorX<drake::symbolic::Expression> m_value_t0(degree_ + 1);
-	Eigen::VectorX<drake::symbolic::Expression> m_value_t1(degree_ + 1);
-	drake::symbolic::Environment t0 {{t_, 0.0}};
-	drake::symbolic::Environment t1 {{t_, 1.0}};
-	for (int d = 0; d < degree_ + 1; ++d)
+	for (int j = 0; j < num_traj_segments_ - 1; ++j)
 	{
-		m_value_t0(d) = m_(d).Evaluate(t0);
-		m_value_t1(d) = m_(d).Evaluate(t1);
+		const Eigen::MatrixXd A_continuity = get_continuity_A(j);
+		for (int i = 0; i < Dim; ++i)
+		{
+			Eigen::Matrix<drake::symbolic::Variable, 2 * Blocks::kNumCoeffs, 1> vars;
+			vars << coeffs_[j](i, Eigen::all).transpose(),
+							coeffs_[j + 1](i, Eigen::all).transpose();
+			continuity_constraints_.push_back(
+					prog_.AddLinearEqualityConstraint(A_continuity, b_continuity, vars)
+					);
+		}
 	}
 
-	// Enforce continuity up to required continuity degree
-	// For each polynomial segment
-	for (int j = 0; j < num_traj_segments_ - 1; ++j)
+	// Add initial and final conditions, starting and ending at rest.
+	// The start constraints are also kept for update_initial_state.
+	const auto table_t1 = Blocks::derivative_table(1.0);
+	unit_init_A_ = Blocks::derivative_table(0.0).template topRows<3>();
+	const Eigen::MatrixXd A_init = get_init_A();
+	for (int i = 0; i < Dim; ++i)
 	{
-		auto left_val = coeffs_[j] * m_value_t1;
-		auto right_val = coeffs_[j + 1] * m_value_t0;
-		prog_.AddLinearConstraint(left_val.array() == right_val.array());
+		const Eigen::Vector3d b_init(init_cond(i), 0, 0);
+		init_constraints_.push_back(prog_.AddLinearEqualityConstraint(
+				A_init, b_init, coeffs_[0](i, Eigen::all).transpose()
+				));
 
-		// For each derivative degree up to required continuity degree
-		for (int d = 1; d < continuity_degree_ + 1; ++d)
-		{
-			auto left_val = coeffs_d_[j][d - 1] * m_value_t1;
-			auto right_val = coeffs_d_[j + 1][d - 1] * m_value_t0;
-			prog_.AddLinearConstraint(left_val.array() == right_val.array());
-		}
+		const Eigen::Vector3d b_final(final_cond(i), 0, 0);
+		prog_.AddLinearEqualityConstraint(
+				table_t1.template topRows<3>(), b_final,
+				coeffs_[num_traj_segments_ - 1](i, Eigen::all).transpose()
+				);
 	}
 
-	// Add initial and final conditions
-	prog_.AddLinearConstraint((coeffs_[0] * m_value_t0).array() == init_cond.array());
+	// Minimize the integral of the squared k-th derivative over each segment,
+	// int_0^T_j || x^(k)(t) ||^2 dt = sum_i c_i^T * Q * c_i / T_j^(2k - 1)
+	// with Q from MISOSBlocks::integral_hessian. The quadratic cost is written
+	// as a linear cost on a(j) with the rotated Lorentz cone
+	// a(j) * T_j^(2k - 1) >= sum_i || R * c_i ||^2, to keep the problem conic.
+	constexpr int Order = Blocks::kCostDerivativeOrder;
+	constexpr int kNumCostVars = Dim * Blocks::kNumCostCoeffs;
+	cost_derivative_order_ = Order;
 
-	prog_.AddLinearConstraint(
-			(coeffs_[num_traj_segments_ - 1] * m_value_t1).array() == final_cond.array());
+	// [a(j); vec(C_j(:, k:))] with vec stacked column by column
+	cost_cone_A_ = Eigen::MatrixXd::Zero(kNumCostVars + 2, kNumCostVars + 1);
+	cost_cone_A_(0, 0) = 1;
+	const auto& R = Blocks::cost_factor();
+	for (int i = 0; i < Dim; ++i)
+		for (int row = 0; row < Blocks::kNumCostCoeffs; ++row)
+			for (int n = 0; n < Blocks::kNumCostCoeffs; ++n)
+				cost_cone_A_(2 + i * Blocks::kNumCostCoeffs + row, 1 + n * Dim + i) = R(row, n);
 
-	// TODO change
-	// Force start and end velocity and acceleration to be zero
-	for (int d = 1; d <= 2; ++d)
+	auto a = prog_.NewContinuousVariables(num_traj_segments_, "a");
+	for (int j = 0; j < num_traj_segments_; ++j)
 	{
-		prog_.AddLinearConstraint(
-				(coeffs_d_[0][d - 1] * m_value_t0).array() == Eigen::VectorXd::Zero(num_vars_).array()
-			);
-		prog_.AddLinearConstraint(
-				(coeffs_d_[num_traj_segments_ - 1][d - 1] * m_value_t1).array()
-				== Eigen::VectorXd::Zero(num_vars_).array()
-			);
+		prog_.AddLinearCost(a(j));
+
+		Eigen::Matrix<drake::symbolic::Variable, kNumCostVars + 1, 1> vars;
+		vars(0) = a(j);
+		for (int n = 0; n < Blocks::kNumCostCoeffs; ++n)
+			for (int i = 0; i < Dim; ++i)
+				vars(1 + n * Dim + i) = coeffs_[j](i, Order + n);
+		cost_cones_.push_back(prog_.AddRotatedLorentzConeConstraint(
+					cost_cone_A_, get_cost_cone_b(j), vars
+					));
 	}
+}
 
-	// Add cost to minimize highest derivative order coefficients
-	// Reformulate cost to be linear for correct SDP problem formulation
-	// (Cost is actually quadratic)
-	auto a = prog_.NewContinuousVariables(num_traj_segments, "a");
-	for (int j = 0; j < num_traj_segments_; ++j)
+Eigen::MatrixXd MISOSProblem::get_continuity_A(int j) const
+{
+	const int num_coeffs = degree_ + 1;
+	Eigen::MatrixXd A = unit_continuity_A_;
+	for (int k = 0; k < continuity_degree_ + 1; ++k)
 	{
-		prog_.AddLinearCost(a(j));
-		// Remember that highest order derivative only has one coefficient
-		auto quadratic_form = coeffs_d_[j][degree_ - 1](Eigen::all, 0)
-			.dot(coeffs_d_[j][degree_ - 1](Eigen::all, 0));
-		prog_.AddLorentzConeConstraint(a(j), quadratic_form);
+		A.row(k).head(num_coeffs) /= std::pow(segment_durations_[j], k);
+		A.row(k).tail(num_coeffs) /= std::pow(segment_durations_[j + 1], k);
 	}
+	return A;
 }
 
-// Returns coefficients in t
-Eigen::VectorX<drake::symbolic::Expression> MISOSProblem::get_coefficients_in_t(drake::symbolic::Polynomial p)
+Eigen::MatrixXd MISOSProblem::get_init_A() const
 {
-	Eigen::VectorX<drake::symbolic::Expression> c(degree_ + 1);
-	auto coeff_map = p.monomial_to_coefficient_map();
+	Eigen::MatrixXd A = unit_init_A_;
+	for (int k = 0; k < 3; ++k)
+		A.row(k) /= std::pow(segment_durations_[0], k);
+	return A;
+}
 
-	// mm = monomial
-	for (int mm_deg = 0; mm_deg < degree_ + 1; ++mm_deg)
-		c(mm_deg) = coeff_map[drake::symbolic::Monomial(m_(mm_deg))];
+Eigen::VectorXd MISOSProblem::get_cost_cone_b(int j) const
+{
+	Eigen::VectorXd b = Eigen::VectorXd::Zero(cost_cone_A_.rows());
+	b(1) = std::pow(segment_durations_[j], 2 * cost_derivative_order_ - 1);
+	return b;
+}
 
-	return c;
+// Returns the coefficients of a segment stacked column by column,
+// i.e. the coefficient of t^k for variable i is at index k * num_vars + i
+drake::solvers::VectorXDecisionVariable MISOSProblem::get_coefficient_vector(
+		int segment_number
+		)
+{
+	return Eigen::Map<const drake::solvers::VectorXDecisionVariable>(
+			coeffs_[segment_number].data(), coeffs_[segment_number].size()
+			);
+}
+
+// Adds the decision variables for a certificate
+// q(t) = t * sigma_1(t) + (1 - t) * sigma_2(t), with sigma_1 and sigma_2 SOS,
+// which ensures q(t) >= 0 on [0, 1]. The certificate variables are mapped to
+// the coefficients of q in t by MISOSBlocks::certificate_map().
+template <int Degree, int Dim>
+drake::solvers::VectorXDecisionVariable MISOSProblem::add_nonnegativity_certificate()
+{
+	using Blocks = MISOSBlocks<Degree, Dim>;
+	drake::solvers::VectorXDecisionVariable vars(Blocks::kNumCertificateVars);
+
+	// Add second order cone constraint for polynomials of degree 3
+	if constexpr (Blocks::kUseSocpCertificate)
+	{
+		drake::solvers::MatrixXDecisionVariable sigma_coeffs =
+			prog_.NewContinuousVariables(2, 3, "Beta");
+		vars << sigma_coeffs(0, Eigen::all).transpose(),
+						sigma_coeffs(1, Eigen::all).transpose();
+
+		// beta_0 * beta_2 >= 0.25 * beta_1^2
+		Eigen::Matrix3d A_rotated_cone;
+		A_rotated_cone << 1, 0, 0,
+											0, 0, 1,
+											0, 0.5, 0;
+		for (int k = 0; k < 2; ++k)
+			prog_.AddRotatedLorentzConeConstraint(
+					A_rotated_cone, Eigen::Vector3d::Zero(), vars.segment<3>(3 * k)
+					);
+	}
+	// Add SOS constraints for all other degrees
+	// NOTE: Mosek does currently not support MISDP problems,
+	// which MI with SOS constraints will be translated to.
+	else
+	{
+		drake::VectorX<drake::symbolic::Monomial> basis(Blocks::kGramSize);
+		for (int k = 0; k < Blocks::kGramSize; ++k)
+			basis(k) = drake::symbolic::Monomial(t_, k);
+
+		// sigma(t) = basis^T * Q * basis with Q PSD.
+		// The upper triangle of the Gram matrix Q is used as variables.
+		int index = 0;
+		for (int k = 0; k < 2; ++k)
+		{
+			auto gram = prog_.NewSosPolynomial(basis).second;
+			for (int row = 0; row < Blocks::kGramSize; ++row)
+				for (int col = row; col < Blocks::kGramSize; ++col)
+					vars(index++) = gram(row, col);
+		}
+	}
+
+	return vars;
 }
 
 void MISOSProblem::add_convex_regions(
@@ -140,96 +262,494 @@ void MISOSProblem::add_convex_regions(
 	num_regions_ = As.size();
 	regions_A_ = As;
 	regions_b_ = bs;
+	calc_big_M();
+}
+
+void MISOSProblem::add_shared_halfspaces(
+		const Eigen::MatrixXd& A, const Eigen::VectorXd& b
+		)
+{
+	assert((int) regions_A_.size() == num_regions_);
+	regions_A_.push_back(A);
+	regions_b_.push_back(b);
+	calc_big_M();
+
+	for (int j = 0; j < num_traj_segments_; ++j)
+		add_region_constraint(num_regions_, j, true);
+}
+
+void MISOSProblem::set_workspace_bounds(
+		const Eigen::VectorXd& lower, const Eigen::VectorXd& upper
+		)
+{
+	assert(lower.size() == num_vars_ && upper.size() == num_vars_);
+	workspace_lower_ = lower;
+	workspace_upper_ = upper;
+	calc_big_M();
+}
+
+void MISOSProblem::set_big_M(const std::vector<Eigen::VectorXd>& big_M)
+{
+	assert(big_M.size() == regions_A_.size());
+	for (int r = 0; r < (int) regions_A_.size(); ++r)
+		assert(big_M[r].size() == regions_A_[r].rows());
+	big_M_ = big_M;
+}
+
+// The trajectory always lies in the region of its segment, and thus in the
+// workspace box, so a halfspace can be relaxed by at most
+// max_{x in box} a_i^T x - b_i + r
+void MISOSProblem::calc_big_M()
+{
+	big_M_.clear();
+	for (int r = 0; r < (int) regions_A_.size(); ++r)
+		if (workspace_lower_.size() == 0)
+			big_M_.push_back(
+					Eigen::VectorXd::Constant(regions_A_[r].rows(), default_big_M_)
+					);
+		else
+			big_M_.push_back(calc_tight_big_M(
+						regions_A_[r], regions_b_[r],
+						workspace_lower_, workspace_upper_, vehicle_radius_
+						));
+}
+
+void MISOSProblem::set_region_containment(RegionContainment region_containment)
+{
+	region_containment_ = region_containment;
+}
+
+void MISOSProblem::set_region_formulation(RegionFormulation region_formulation)
+{
+	region_formulation_ = region_formulation;
+}
+
+void MISOSProblem::set_lazy_region_constraints(bool lazy_region_constraints)
+{
+	lazy_region_constraints_ = lazy_region_constraints;
+}
+
+void MISOSProblem::set_monotone_region_order(bool monotone_region_order)
+{
+	monotone_region_order_ = monotone_region_order;
+}
+
+void MISOSProblem::set_no_return_cuts(bool no_return_cuts)
+{
+	no_return_cuts_ = no_return_cuts;
+}
+
+void MISOSProblem::set_replanning(bool replanning)
+{
+	replanning_ = replanning;
+}
+
+void MISOSProblem::set_fixed_region_prefix(const std::vector<int>& regions)
+{
+	assert((int) regions.size() <= num_traj_segments_);
+	fixed_region_prefix_ = regions;
+}
+
+void MISOSProblem::add_region_graph(const RegionGraph* region_graph)
+{
+	assert(region_graph->get_num_regions() == num_regions_);
+	region_graph_ = region_graph;
 }
 
 // Will create a binary decision variable for each combination of region and segment
-void MISOSProblem::create_region_binary_variables()
+void MISOSProblem::create_region_binary_variables(bool relax_binaries)
 {
-	H_ = prog_.NewBinaryVariables(num_regions_, num_traj_segments_, "H");
+	// Pending halfspaces are checked with the big M relaxation
+	assert(!lazy_region_constraints_ || region_formulation_ == RegionFormulation::kBigM);
+	// The monotone region order depends on the start
+	assert(!replanning_ || !monotone_region_order_);
+	// The coefficient copies of unselected regions are only forced to zero
+	// if the regions are bounded, which they may not be without the shared facets
+	assert(region_formulation_ != RegionFormulation::kConvexHull
+			|| (int) regions_A_.size() == num_regions_);
+
+	if (relax_binaries)
+	{
+		H_ = prog_.NewContinuousVariables(num_regions_, num_traj_segments_, "H");
+		prog_.AddBoundingBoxConstraint(0, 1, H_);
+	}
+	else
+	{
+		H_ = prog_.NewBinaryVariables(num_regions_, num_traj_segments_, "H");
+		has_binary_variables_ = true;
+	}
 
 	// Ensure that each traj segment is strictly within one region
 	for (int j = 0; j < num_traj_segments_; ++j)
-		prog_.AddLinearConstraint(H_(Eigen::all, j).sum() == 1);
+		prog_.AddLinearEqualityConstraint(
+				Eigen::RowVectorXd::Ones(num_regions_), Eigen::VectorXd::Ones(1),
+				H_(Eigen::all, j)
+				);
 
-	// Add one constraint for each combination of region and segment
+	// Add one constraint for each reachable combination of region and segment,
+	// and fix the binaries of the others to zero.
+	// In lazy mode, the halfspaces are only marked as pending.
+	Eigen::MatrixX<bool> reachable = get_reachable_regions();
+	for (int j = 0; j < (int) fixed_region_prefix_.size(); ++j)
+	{
+		reachable.col(j).setConstant(false);
+		reachable(fixed_region_prefix_[j], j) = true;
+	}
+	if (region_formulation_ == RegionFormulation::kConvexHull)
+		add_region_coefficient_copies(reachable);
+	pending_halfspaces_.assign(
+			num_traj_segments_, std::vector<std::vector<int>>(num_regions_)
+			);
+	for (int j = 0; j < num_traj_segments_; ++j)
+		for (int r = 0; r < num_regions_; ++r)
+			if (!reachable(r,j))
+				prog_.AddBoundingBoxConstraint(0, 0, H_(r,j));
+			else if (lazy_region_constraints_)
+			{
+				pending_halfspaces_[j][r].resize(regions_A_[r].rows());
+				std::iota(pending_halfspaces_[j][r].begin(), pending_halfspaces_[j][r].end(), 0);
+			}
+			else
+				add_region_constraint(r,j);
+
+	if (region_graph_ != nullptr)
+	{
+		add_region_transition_constraints(reachable);
+		if (monotone_region_order_)
+			add_monotone_region_order_constraints();
+		if (no_return_cuts_)
+			add_no_return_constraints(reachable);
+	}
+}
+
+// Splits the coefficients of each segment into one copy per reachable region,
+// C_j = sum_r C_j^r. The region constraints are added for the copies,
+// which are forced to zero when the region is not selected.
+void MISOSProblem::add_region_coefficient_copies(const Eigen::MatrixX<bool>& reachable)
+{
+	region_coeffs_.assign(
+			num_traj_segments_, std::vector<drake::solvers::MatrixXDecisionVariable>(num_regions_)
+			);
 	for (int j = 0; j < num_traj_segments_; ++j)
+	{
+		const int num_copies = reachable.col(j).count();
+		const int num_coeffs = coeffs_[j].size();
+
+		// [I, -I, ..., -I] * [vec(C_j); vec(C_j^r1); ...] = 0
+		Eigen::MatrixXd A(num_coeffs, num_coeffs * (num_copies + 1));
+		drake::solvers::VectorXDecisionVariable vars(A.cols());
+		A.leftCols(num_coeffs).setIdentity();
+		vars.head(num_coeffs) = get_coefficient_vector(j);
+
+		int k = 1;
 		for (int r = 0; r < num_regions_; ++r)
-			add_region_constraint(r,j);
+		{
+			if (!reachable(r,j)) continue;
+
+			region_coeffs_[j][r] = prog_.NewContinuousVariables(
+					num_vars_, degree_ + 1, "C_r"
+					);
+			A.middleCols(k * num_coeffs, num_coeffs) =
+				-Eigen::MatrixXd::Identity(num_coeffs, num_coeffs);
+			vars.segment(k * num_coeffs, num_coeffs) =
+				Eigen::Map<const drake::solvers::VectorXDecisionVariable>(
+						region_coeffs_[j][r].data(), num_coeffs
+						);
+			++k;
+		}
+
+		prog_.AddLinearEqualityConstraint(A, Eigen::VectorXd::Zero(num_coeffs), vars);
+	}
+}
+
+// Segment j can only be in region r if r can be reached from the start
+// in at most j transitions, and the goal from r in the remaining segments
+Eigen::MatrixX<bool> MISOSProblem::get_reachable_regions()
+{
+	Eigen::MatrixX<bool> reachable =
+		Eigen::MatrixX<bool>::Constant(num_regions_, num_traj_segments_, true);
+	if (region_graph_ == nullptr) return reachable;
+
+	auto start_regions = region_graph_->get_regions_containing(init_cond_);
+	auto goal_regions = region_graph_->get_regions_containing(final_cond_);
+	if (start_regions.empty() || goal_regions.empty())
+	{
+		std::cout << "Start or goal outside all regions, no pruning" << std::endl;
+		return reachable;
+	}
+
+	auto dist_from_start = region_graph_->get_distances(start_regions);
+	auto dist_to_goal = region_graph_->get_distances(goal_regions);
+	for (int r = 0; r < num_regions_; ++r)
+		for (int j = 0; j < num_traj_segments_; ++j)
+			reachable(r,j) = (replanning_
+					|| (dist_from_start[r] != -1 && dist_from_start[r] <= j))
+				&& dist_to_goal[r] != -1 && dist_to_goal[r] <= num_traj_segments_ - 1 - j;
+
+	// The remaining segments start from the last fixed region
+	const int num_fixed = fixed_region_prefix_.size();
+	if (num_fixed > 0)
+	{
+		auto dist_from_prefix = region_graph_->get_distances({ fixed_region_prefix_.back() });
+		for (int r = 0; r < num_regions_; ++r)
+			for (int j = num_fixed; j < num_traj_segments_; ++j)
+				reachable(r,j) = reachable(r,j) && dist_from_prefix[r] != -1
+					&& dist_from_prefix[r] <= j - num_fixed + 1;
+	}
+
+	return reachable;
+}
+
+// If segment j + 1 is in region r, segment j must be in r or one of its neighbours:
+// H(r, j + 1) <= H(r, j) + sum_{n in N(r)} H(n, j)
+void MISOSProblem::add_region_transition_constraints(
+		const Eigen::MatrixX<bool>& reachable
+		)
+{
+	for (int j = 0; j < num_traj_segments_ - 1; ++j)
+		for (int r = 0; r < num_regions_; ++r)
+		{
+			if (!reachable(r, j + 1)) continue;
+
+			const auto& neighbours = region_graph_->get_neighbours(r);
+			drake::solvers::VectorXDecisionVariable vars(neighbours.size() + 2);
+			Eigen::RowVectorXd A(neighbours.size() + 2);
+			vars(0) = H_(r, j + 1);
+			vars(1) = H_(r, j);
+			A(0) = 1;
+			A(1) = -1;
+			for (int k = 0; k < (int) neighbours.size(); ++k)
+			{
+				vars(k + 2) = H_(neighbours[k], j);
+				A(k + 2) = -1;
+			}
+
+			prog_.AddLinearConstraint(
+					A, Eigen::VectorXd::Constant(1, -std::numeric_limits<double>::infinity()),
+					Eigen::VectorXd::Zero(1), vars
+					);
+		}
+}
+
+// With d(r) the region graph distance of r from the start regions:
+// sum_r d(r) * H(r, j + 1) >= sum_r d(r) * H(r, j)
+void MISOSProblem::add_monotone_region_order_constraints()
+{
+	auto start_regions = region_graph_->get_regions_containing(init_cond_);
+	if (start_regions.empty()) return;
+	auto dist_from_start = region_graph_->get_distances(start_regions);
+
+	// Unreachable regions are fixed to zero, and get no weight
+	Eigen::RowVectorXd d(num_regions_);
+	for (int r = 0; r < num_regions_; ++r)
+		d(r) = std::max(dist_from_start[r], 0);
+
+	Eigen::RowVectorXd A(2 * num_regions_);
+	A << d, -d;
+	for (int j = 0; j < num_traj_segments_ - 1; ++j)
+	{
+		drake::solvers::VectorXDecisionVariable vars(2 * num_regions_);
+		vars << H_(Eigen::all, j + 1), H_(Eigen::all, j);
+		prog_.AddLinearConstraint(
+				A, Eigen::VectorXd::Zero(1),
+				Eigen::VectorXd::Constant(1, std::numeric_limits<double>::infinity()), vars
+				);
+	}
+}
+
+// Counts the entries into each region with continuous variables
+// e_j >= H(r, j + 1) - H(r, j), e_j >= 0, which are at least one for each entry
+// if H is binary, and allows at most one: H(r, 0) + sum_j e_j <= 1
+void MISOSProblem::add_no_return_constraints(const Eigen::MatrixX<bool>& reachable)
+{
+	const int num_transitions = num_traj_segments_ - 1;
+	// e_j - H(r, j + 1) + H(r, j) >= 0 with the variables [e; H(r, :)]
+	Eigen::MatrixXd A_entry = Eigen::MatrixXd::Zero(num_transitions, 2 * num_transitions + 1);
+	for (int j = 0; j < num_transitions; ++j)
+	{
+		A_entry(j, j) = 1;
+		A_entry(j, num_transitions + j) = 1;
+		A_entry(j, num_transitions + j + 1) = -1;
+	}
+	Eigen::RowVectorXd A_count(num_transitions + 1);
+	A_count.setOnes();
+
+	for (int r = 0; r < num_regions_; ++r)
+	{
+		// Regions reachable by at most one segment can not be entered twice
+		if (reachable.row(r).count() <= 1) continue;
+
+		auto entries = prog_.NewContinuousVariables(num_transitions, "E");
+		prog_.AddBoundingBoxConstraint(0, 1, entries);
+
+		drake::solvers::VectorXDecisionVariable vars(2 * num_transitions + 1);
+		vars << entries, H_(r, Eigen::all).transpose();
+		prog_.AddLinearConstraint(
+				A_entry, Eigen::VectorXd::Zero(num_transitions),
+				Eigen::VectorXd::Constant(num_transitions, std::numeric_limits<double>::infinity()),
+				vars
+				);
+
+		drake::solvers::VectorXDecisionVariable count_vars(num_transitions + 1);
+		count_vars << H_(r, 0), entries;
+		prog_.AddLinearConstraint(
+				A_count, Eigen::VectorXd::Constant(1, -std::numeric_limits<double>::infinity()),
+				Eigen::VectorXd::Ones(1), count_vars
+				);
+	}
 }
 
 void MISOSProblem::add_region_constraint(
 		int region_number, int segment_number, bool always_enforce
 		)
 {
-	for (int i = 0; i < regions_A_[region_number].rows(); ++i)
+	std::vector<int> halfspaces(regions_A_[region_number].rows());
+	std::iota(halfspaces.begin(), halfspaces.end(), 0);
+	add_region_halfspaces(region_number, segment_number, halfspaces, always_enforce);
+}
+
+void MISOSProblem::add_region_halfspaces(
+		int region_number, int segment_number,
+		const std::vector<int>& halfspaces, bool always_enforce
+		)
+{
+	if (halfspaces.empty()) return;
+	num_region_halfspaces_ += halfspaces.size();
+
+	dispatch_problem_size(degree_, num_vars_, [&](auto degree_c, auto dim_c)
 	{
-		auto ai_transpose = regions_A_[region_number](i, Eigen::all);
-		auto bi = regions_b_[region_number](i);
-
-		drake::symbolic::Polynomial q;
-		if (always_enforce)
-			// Force constaint to always be true
-			q = drake::symbolic::Polynomial(
-				bi - vehicle_radius_ - ai_transpose * coeffs_[segment_number] * m_,
-				{t_}
-				);
+		constexpr int Degree = decltype(degree_c)::value;
+		constexpr int Dim = decltype(dim_c)::value;
+		if (region_containment_ == RegionContainment::kControlPoints)
+			add_control_point_constraint_impl<Degree, Dim>(
+					region_number, segment_number, halfspaces, always_enforce
+					);
 		else
-			// Use binary decision variable and big M
-			// to only enforce constraints when binary decision variable is 1
-			q = drake::symbolic::Polynomial(
-					big_M_ * (1 - H_(region_number, segment_number)) +
-					bi - vehicle_radius_ - ai_transpose * coeffs_[segment_number] * m_,
-					{t_}
+			add_region_constraint_impl<Degree, Dim>(
+					region_number, segment_number, halfspaces, always_enforce
 					);
+	});
+}
 
-		drake::symbolic::Polynomial sigma_1;
-		drake::symbolic::Polynomial sigma_2;
+// The coefficients constrained to the region, followed by the region binary
+// unless the constraint is always enforced. With the convex hull formulation,
+// these are the coefficient copies of the region.
+drake::solvers::VectorXDecisionVariable MISOSProblem::get_region_constraint_vars(
+		int region_number, int segment_number, bool always_enforce
+		)
+{
+	// Force constaint to always be true
+	if (always_enforce)
+		return get_coefficient_vector(segment_number);
 
-		// Add second order cone constraint for polynomials of degree 3
-		if (degree_ == 3)
-		{
-			coeff_matrix_t sigma_coeffs = prog_.NewContinuousVariables(2, 3, "Beta");
+	// Use binary decision variable to only enforce constraints
+	// when binary decision variable is 1
+	const auto& coeffs = region_formulation_ == RegionFormulation::kConvexHull
+		? region_coeffs_[segment_number][region_number] : coeffs_[segment_number];
+	drake::solvers::VectorXDecisionVariable vars(coeffs.size() + 1);
+	vars << Eigen::Map<const drake::solvers::VectorXDecisionVariable>(
+			coeffs.data(), coeffs.size()
+			),
+			H_(region_number, segment_number);
+	return vars;
+}
+
+// a_i^T * P_k <= b_i - r + big_M * (1 - h) for all halfspaces i and
+// control points P_k, added as one linear constraint
+template <int Degree, int Dim>
+void MISOSProblem::add_control_point_constraint_impl(
+		int region_number, int segment_number,
+		const std::vector<int>& halfspaces, bool always_enforce
+		)
+{
+	using Blocks = MISOSBlocks<Degree, Dim>;
+	const int num_halfspaces = halfspaces.size();
+	const int num_p_vars = always_enforce
+		? Blocks::kNumSegmentVars : Blocks::kNumSegmentVars + 1;
 
-			sigma_1  = drake::symbolic::Polynomial(
-					sigma_coeffs(0, Eigen::all).dot(m_(Eigen::seq(0,2))),
-					{t_}
+	drake::solvers::VectorXDecisionVariable vars =
+		get_region_constraint_vars(region_number, segment_number, always_enforce);
+	const bool perspective = !always_enforce
+		&& region_formulation_ == RegionFormulation::kConvexHull;
+
+	typename Blocks::HalfspaceMatrix A_p;
+	typename Blocks::CoeffVector ub_p;
+	Eigen::MatrixXd A(num_halfspaces * Blocks::kNumCoeffs, num_p_vars);
+	Eigen::VectorXd ub(num_halfspaces * Blocks::kNumCoeffs);
+	for (int k = 0; k < num_halfspaces; ++k)
+	{
+		const int i = halfspaces[k];
+		if (perspective)
+			Blocks::perspective_control_point_block(
+					regions_A_[region_number](i, Eigen::all).transpose(),
+					regions_b_[region_number](i), vehicle_radius_, &A_p, &ub_p
 					);
-			sigma_2  = drake::symbolic::Polynomial(
-					sigma_coeffs(1, Eigen::all).dot(m_(Eigen::seq(0,2))),
-					{t_}
+		else
+			Blocks::control_point_block(
+					regions_A_[region_number](i, Eigen::all).transpose(),
+					regions_b_[region_number](i),
+					vehicle_radius_, always_enforce ? 0.0 : big_M_[region_number](i),
+					&A_p, &ub_p
 					);
+		A.middleRows<Blocks::kNumCoeffs>(k * Blocks::kNumCoeffs) =
+			A_p.leftCols(num_p_vars);
+		ub.segment<Blocks::kNumCoeffs>(k * Blocks::kNumCoeffs) = ub_p;
+	}
 
-			prog_.AddRotatedLorentzConeConstraint(
-					sigma_coeffs(0,0),
-					sigma_coeffs(0,2),
-					0.25 * sigma_coeffs(0,1) * sigma_coeffs(0,1)
-					);
+	prog_.AddLinearConstraint(
+			A, Eigen::VectorXd::Constant(ub.size(), -std::numeric_limits<double>::infinity()),
+			ub, vars
+			);
+}
 
-			prog_.AddRotatedLorentzConeConstraint(
-					sigma_coeffs(1,0),
-					sigma_coeffs(1,2),
-					0.25 * sigma_coeffs(1,1) * sigma_coeffs(1,1)
+template <int Degree, int Dim>
+void MISOSProblem::add_region_constraint_impl(
+		int region_number, int segment_number,
+		const std::vector<int>& halfspaces, bool always_enforce
+		)
+{
+	using Blocks = MISOSBlocks<Degree, Dim>;
+	const int num_q_vars = always_enforce
+		? Blocks::kNumSegmentVars : Blocks::kNumSegmentVars + 1;
+
+	drake::solvers::VectorXDecisionVariable q_vars =
+		get_region_constraint_vars(region_number, segment_number, always_enforce);
+	const bool perspective = !always_enforce
+		&& region_formulation_ == RegionFormulation::kConvexHull;
+
+	typename Blocks::HalfspaceMatrix A_q;
+	typename Blocks::CoeffVector b_q;
+	Eigen::Matrix<double, Blocks::kNumCoeffs, Eigen::Dynamic, Eigen::ColMajor,
+		Blocks::kNumCoeffs, Blocks::kNumSegmentVars + 1 + Blocks::kNumCertificateVars> A;
+
+	for (int i : halfspaces)
+	{
+		// q(t) = big_M * (1 - h) + b_i - r - a_i^T * C * m(t), or
+		// q(t) = h * (b_i - r) - a_i^T * C_r * m(t) for the convex hull formulation
+		if (perspective)
+			Blocks::perspective_halfspace_block(
+					regions_A_[region_number](i, Eigen::all).transpose(),
+					regions_b_[region_number](i), vehicle_radius_, &A_q, &b_q
 					);
-		}
-		// Add SOS constraints for all other degrees
-		// NOTE: Mosek does currently not support MISDP problems,
-		// which MI with SOS constraints will be translated to.
 		else
-		{
-			sigma_1 = prog_.NewSosPolynomial(
-					{t_}, degree_ - 1
-					).first;
-			sigma_2 = prog_.NewSosPolynomial(
-					{t_}, degree_ - 1
-					).first;
-		}
+			Blocks::halfspace_block(
+					regions_A_[region_number](i, Eigen::all).transpose(),
+					regions_b_[region_number](i),
+					vehicle_radius_, always_enforce ? 0.0 : big_M_[region_number](i),
+					&A_q, &b_q
+					);
 
 		// Add constraints: q(t) = t * sigma1(t) + (1 - t) * sigma2(t)
-		// by setting coefficiants equal
-		prog_.AddLinearConstraint(
-				get_coefficients_in_t(q).array() ==
-				get_coefficients_in_t(t_ * sigma_1 + sigma_2 - t_ * sigma_2).array()
+		// by setting coefficients equal
+		drake::solvers::VectorXDecisionVariable vars(
+				num_q_vars + Blocks::kNumCertificateVars
 				);
+		vars << q_vars, add_nonnegativity_certificate<Degree, Dim>();
+
+		A.resize(Blocks::kNumCoeffs, vars.size());
+		A << A_q.leftCols(num_q_vars), -Blocks::certificate_map();
+
+		prog_.AddLinearEqualityConstraint(A, -b_q, vars);
 	}
 }
 
@@ -244,53 +764,311 @@ void MISOSProblem::add_safe_region_assignments(
 				add_region_constraint(r, j, true);
 }
 
-void MISOSProblem::generate()
+// Sets the initial guess for the coefficients from a trajectory with the same
+// number of segments and at most the same degree. A lower degree polynomial is
+// lifted exactly by setting its higher order coefficients to zero, and each
+// segment is mapped to [0, 1] by its duration in the trajectory.
+void MISOSProblem::set_initial_guess(const SolvedTrajectory& traj)
 {
-	result_ = Solve(prog_);
-	std::cout << "Solver id: " << result_.get_solver_id() << std::endl;
-	std::cout << "Found solution: " << result_.is_success() << std::endl;
-	std::cout << "Solution result: " << result_.get_solution_result() << std::endl;
-	auto details = result_.get_solver_details<drake::solvers::MosekSolver>();
-	std::cout << "Solver details: rescode: \n" << details.rescode << std::endl;
-	std::cout << "Solver details: solution_status: \n" << details.solution_status << std::endl;
-	assert(result_.is_success());
+	assert(traj.get_num_segments() == num_traj_segments_);
+	assert(traj.get_num_vars() == num_vars_);
+	assert(traj.get_degree() <= degree_);
 
-	generate_polynomials();
-	generate_derivative_polynomials();
+	const std::vector<double>& breaks = traj.get_breaks();
+	for (int j = 0; j < num_traj_segments_; ++j)
+	{
+		Eigen::MatrixXd lifted_coeffs = Eigen::MatrixXd::Zero(num_vars_, degree_ + 1);
+		lifted_coeffs.leftCols(traj.get_degree() + 1) = traj.get_segment_coeffs(j);
+		for (int n = 0; n < traj.get_degree() + 1; ++n)
+			lifted_coeffs.col(n) *= std::pow(breaks[j + 1] - breaks[j], n);
+		prog_.SetInitialGuess(coeffs_[j], lifted_coeffs);
+	}
 }
 
-void MISOSProblem::generate_polynomials()
+void MISOSProblem::set_initial_guess(const Eigen::MatrixX<int>& region_assignments)
 {
-	polynomials_.resize(num_vars_, num_traj_segments_);
-	for (int j = 0; j < num_traj_segments_; ++j)
-	{
-		Eigen::VectorX<drake::symbolic::Expression> expr = result_
-			.GetSolution(coeffs_[j]) * m_;
+	assert(region_assignments.rows() == num_regions_);
+	assert(region_assignments.cols() == num_traj_segments_);
+	prog_.SetInitialGuess(H_, region_assignments.cast<double>());
+}
 
+// Only the right hand sides of the start constraints change,
+// the k-th time derivative is the k-th derivative in s divided by T_0^k
+void MISOSProblem::update_initial_state(const Eigen::MatrixXd& init_state)
+{
+	assert(init_state.rows() == num_vars_ && init_state.cols() == 3);
+	assert(region_graph_ == nullptr || H_.size() == 0 || replanning_);
+
+	init_cond_ = init_state.col(0);
+	const Eigen::MatrixXd A_init =
+		init_constraints_[0].evaluator()->GetDenseA();
+	for (int i = 0; i < num_vars_; ++i)
+		init_constraints_[i].evaluator()->UpdateCoefficients(
+				A_init, init_state.row(i).transpose()
+				);
+}
+
+// The region constraints are in the normalized time of each segment, only the
+// constraints and costs that relate it to time depend on the durations
+void MISOSProblem::update_segment_durations(const std::vector<double>& segment_durations)
+{
+	assert((int) segment_durations.size() == num_traj_segments_);
+	segment_durations_ = segment_durations;
+
+	const Eigen::VectorXd b_continuity = Eigen::VectorXd::Zero(continuity_degree_ + 1);
+	for (int j = 0; j < num_traj_segments_ - 1; ++j)
+	{
+		const Eigen::MatrixXd A_continuity = get_continuity_A(j);
 		for (int i = 0; i < num_vars_; ++i)
-			polynomials_(i,j) = drake::symbolic::Polynomial(expr[i]);
+			continuity_constraints_[j * num_vars_ + i].evaluator()->UpdateCoefficients(
+					A_continuity, b_continuity
+					);
 	}
+
+	const Eigen::MatrixXd A_init = get_init_A();
+	for (int i = 0; i < num_vars_; ++i)
+		init_constraints_[i].evaluator()->UpdateCoefficients(
+				A_init, init_constraints_[i].evaluator()->lower_bound()
+				);
+
+	for (int j = 0; j < num_traj_segments_; ++j)
+		cost_cones_[j].evaluator()->UpdateCoefficients(cost_cone_A_, get_cost_cone_b(j));
 }
 
-void MISOSProblem::generate_derivative_polynomials()
+bool MISOSProblem::replan(
+		const Eigen::MatrixXd& init_state,
+		double time_shift,
+		SolvedTrajectory* traj
+		)
 {
-	for (int d = 1; d < continuity_degree_ + 1; ++d)
+	update_initial_state(init_state);
+	if (result_.is_success())
 	{
-		Eigen::MatrixX<drake::symbolic::Polynomial> polynomialsDt_(
-				num_vars_, num_traj_segments_
+		set_initial_guess(
+				shift_trajectory(trajectory_, time_shift, trajectory_.get_breaks())
 				);
+		// The region of each segment is shifted by the whole segments that have
+		// passed, and the last region is repeated, which keeps the transitions valid
+		if (H_.size() > 0)
+		{
+			const std::vector<double>& breaks = trajectory_.get_breaks();
+			const int num_passed = std::upper_bound(
+					breaks.begin() + 1, breaks.end(), time_shift
+					) - (breaks.begin() + 1);
+			const Eigen::MatrixXd H = result_.GetSolution(H_);
+			Eigen::MatrixXd H_shifted(H.rows(), H.cols());
+			for (int j = 0; j < num_traj_segments_; ++j)
+				H_shifted.col(j) = H.col(std::min(j + num_passed, num_traj_segments_ - 1));
+			prog_.SetInitialGuess(H_, H_shifted);
+		}
+	}
+
+	return try_generate(traj);
+}
+
+// Solves the program and returns the trajectory as a standalone value,
+// which stays valid after this MISOSProblem is destroyed
+SolvedTrajectory MISOSProblem::generate()
+{
+	solve();
+	assert(result_.is_success());
+	return trajectory_;
+}
+
+bool MISOSProblem::try_generate(SolvedTrajectory* traj)
+{
+	solve();
+	if (!result_.is_success()) return false;
+
+	*traj = trajectory_;
+	return true;
+}
+
+void MISOSProblem::set_solver_id(const drake::solvers::SolverId& solver_id)
+{
+	solver_id_ = solver_id;
+}
+
+void MISOSProblem::set_branch_and_bound(const drake::solvers::SolverId& node_solver_id)
+{
+	branch_and_bound_solver_id_ = node_solver_id;
+}
+
+void MISOSProblem::set_time_limit(double seconds)
+{
+	solver_options_.SetOption(
+			drake::solvers::MosekSolver::id(), "MSK_DPAR_OPTIMIZER_MAX_TIME", seconds
+			);
+	solver_options_.SetOption(
+			drake::solvers::GurobiSolver::id(), "TimeLimit", seconds
+			);
+}
+
+void MISOSProblem::set_verbose(bool verbose)
+{
+	verbose_ = verbose;
+}
+
+// In lazy mode, the program is solved repeatedly with the halfspaces violated by
+// the last solution added, warm started from the last solution, until the
+// solution satisfies all region constraints
+void MISOSProblem::solve()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	statistics_ = SolverStatistics();
+	solve_program();
 
+	num_lazy_iterations_ = 0;
+	while (lazy_region_constraints_ && result_.is_success()
+			&& add_violated_region_halfspaces())
+	{
+		prog_.SetInitialGuess(H_, result_.GetSolution(H_));
 		for (int j = 0; j < num_traj_segments_; ++j)
+			prog_.SetInitialGuess(coeffs_[j], result_.GetSolution(coeffs_[j]));
+
+		solve_program();
+		++num_lazy_iterations_;
+	}
+	if (verbose_ && lazy_region_constraints_)
+		std::cout << "Lazy region constraints: " << num_lazy_iterations_
+			<< " iterations, " << num_region_halfspaces_ << " halfspaces" << std::endl;
+
+	statistics_.solver_name = result_.get_solver_id().name();
+	statistics_.solve_status = get_solve_status();
+	if (result_.is_success())
+	{
+		statistics_.cost = get_cost();
+		statistics_.lower_bound = get_lower_bound();
+	}
+	statistics_.solve_time = std::chrono::duration<double>(
+			std::chrono::high_resolution_clock::now() - start
+			).count();
+	if (verbose_)
+		std::cout << "Solver statistics: " << statistics_ << std::endl;
+}
+
+static int count_nodes(const drake::solvers::MixedIntegerBranchAndBoundNode* node)
+{
+	if (node == nullptr) return 0;
+	return 1 + count_nodes(node->left_child()) + count_nodes(node->right_child());
+}
+
+// Drake's branch-and-bound does not return a MathematicalProgramResult,
+// so one is filled in from its solution for the getters
+void MISOSProblem::solve_branch_and_bound()
+{
+	drake::solvers::MixedIntegerBranchAndBound bnb(prog_, *branch_and_bound_solver_id_);
+	const drake::solvers::SolutionResult solution_result = bnb.Solve();
+
+	result_ = drake::solvers::MathematicalProgramResult();
+	result_.set_decision_variable_index(prog_.decision_variable_index());
+	result_.set_solver_id(*branch_and_bound_solver_id_);
+	result_.set_solution_result(solution_result);
+	if (solution_result == drake::solvers::SolutionResult::kSolutionFound)
+	{
+		result_.set_x_val(bnb.GetSolution(prog_.decision_variables()));
+		result_.set_optimal_cost(bnb.GetOptimalCost());
+	}
+
+	// Summed over the lazy iterations
+	statistics_.num_nodes = std::max(statistics_.num_nodes, 0) + count_nodes(bnb.root());
+	branch_and_bound_lower_bound_ = bnb.GetBestLowerBound();
+}
+
+// Checks the pending halfspaces against the current solution with the same
+// big M relaxation as in the program, i.e.
+// a_i^T * x(t) <= b_i - r + big_M * (1 - h) for all t in [0, 1],
+// and adds the violated ones. Returns false if none are violated.
+bool MISOSProblem::add_violated_region_halfspaces()
+{
+	const double tol = 1e-6;
+	const Eigen::MatrixXd H = result_.GetSolution(H_);
+	const Eigen::MatrixXd bernstein = monomial_to_bernstein(degree_);
+
+	bool violated = false;
+	for (int j = 0; j < num_traj_segments_; ++j)
+	{
+		const Eigen::MatrixXd coeffs = result_.GetSolution(coeffs_[j]);
+		for (int r = 0; r < num_regions_; ++r)
 		{
-			Eigen::VectorX<drake::symbolic::Expression> der_expr = result_
-				.GetSolution(coeffs_d_[j][d - 1]) * m_;
+			std::vector<int>& pending = pending_halfspaces_[j][r];
+			std::vector<int> added;
+			for (auto it = pending.begin(); it != pending.end();)
+			{
+				const int i = *it;
+				const double slack = regions_b_[r](i) - vehicle_radius_
+					+ big_M_[r](i) * (1 - H(r,j));
+				// a_i^T * x(t) with coefficients in t
+				const Eigen::RowVectorXd p = regions_A_[r].row(i) * coeffs;
+
+				bool is_violated;
+				if (region_containment_ == RegionContainment::kControlPoints)
+					is_violated = (p * bernstein).maxCoeff() > slack + tol;
+				else
+				{
+					// Exact check of q(t) = slack - a_i^T * x(t) >= 0 on [0, 1]
+					Eigen::VectorXd q = -p.transpose();
+					q(0) += slack;
+					is_violated = min_on_unit_interval(q) < -tol;
+				}
 
-			for (int i = 0; i < num_vars_; ++i)
-				polynomialsDt_(i,j) = drake::symbolic::Polynomial(der_expr[i]);
+				if (is_violated)
+				{
+					added.push_back(i);
+					it = pending.erase(it);
+				}
+				else
+					++it;
+			}
+
+			if (!added.empty())
+			{
+				add_region_halfspaces(r, j, added, false);
+				violated = true;
+			}
 		}
+	}
+	return violated;
+}
 
-		polynomial_derivatives_.push_back(polynomialsDt_);
+void MISOSProblem::solve_program()
+{
+	if (branch_and_bound_solver_id_.has_value() && has_binary_variables_)
+		solve_branch_and_bound();
+	else if (branch_and_bound_solver_id_.has_value())
+		drake::solvers::MakeSolver(*branch_and_bound_solver_id_)->Solve(
+				prog_, std::nullopt, solver_options_, &result_
+				);
+	else if (solver_id_.has_value())
+		drake::solvers::MakeSolver(*solver_id_)->Solve(
+				prog_, std::nullopt, solver_options_, &result_
+				);
+	else
+		result_ = Solve(prog_, std::nullopt, solver_options_);
+
+	std::cout << "Solver id: " << result_.get_solver_id() << std::endl;
+	std::cout << "Found solution: " << result_.is_success() << std::endl;
+	std::cout << "Solution result: " << result_.get_solution_result() << std::endl;
+	if (result_.get_solver_id() == drake::solvers::MosekSolver::id())
+	{
+		auto details = result_.get_solver_details<drake::solvers::MosekSolver>();
+		std::cout << "Solver details: rescode: \n" << details.rescode << std::endl;
+		std::cout << "Solver details: solution_status: \n" << details.solution_status << std::endl;
 	}
+	if (!result_.is_success()) return;
+
+	// Coefficients in the local time t - t_j instead of s = (t - t_j) / T_j
+	std::vector<Eigen::MatrixXd> solved_coeffs;
+	std::vector<double> breaks = { 0.0 };
+	for (int j = 0; j < num_traj_segments_; ++j)
+	{
+		Eigen::MatrixXd coeffs = result_.GetSolution(coeffs_[j]);
+		for (int n = 0; n < degree_ + 1; ++n)
+			coeffs.col(n) /= std::pow(segment_durations_[j], n);
+		solved_coeffs.push_back(coeffs);
+		breaks.push_back(breaks.back() + segment_durations_[j]);
+	}
+	trajectory_ = SolvedTrajectory(solved_coeffs, breaks);
 }
 
 // ******
@@ -299,19 +1077,56 @@ void MISOSProblem::generate_derivative_polynomials()
 
 Eigen::MatrixX<int> MISOSProblem::get_region_assignments()
 {
-	Eigen::MatrixX<drake::symbolic::Expression> temp = result_.GetSolution(H_);
+	Eigen::MatrixXd temp = result_.GetSolution(H_);
 	Eigen::MatrixX<int> assignments(num_regions_, num_traj_segments_);
 
 	for (int r = 0; r < num_regions_; ++r)
 		for (int j = 0; j < num_traj_segments_; ++j)
-			assignments(r,j) = temp(r,j).Evaluate();
+			assignments(r,j) = std::round(temp(r,j));
 
 	return assignments;
 }
 
+Eigen::MatrixXd MISOSProblem::get_region_weights()
+{
+	return result_.GetSolution(H_);
+}
+
 double MISOSProblem::get_end_time()
 {
-	return num_traj_segments_;
+	return std::accumulate(segment_durations_.begin(), segment_durations_.end(), 0.0);
+}
+
+double MISOSProblem::get_cost()
+{
+	return result_.get_optimal_cost();
+}
+
+SolveStatus MISOSProblem::get_solve_status()
+{
+	if (!result_.is_success()) return SolveStatus::kNoSolution;
+
+	if (result_.get_solver_id() == drake::solvers::MosekSolver::id()
+			&& result_.get_solver_details<drake::solvers::MosekSolver>().rescode
+				== kMosekTerminatedMaxTime)
+		return SolveStatus::kFeasible;
+	if (result_.get_solver_id() == drake::solvers::GurobiSolver::id()
+			&& result_.get_solver_details<drake::solvers::GurobiSolver>().optimization_status
+				== kGurobiTimeLimit)
+		return SolveStatus::kFeasible;
+
+	return SolveStatus::kOptimal;
+}
+
+double MISOSProblem::get_lower_bound()
+{
+	if (branch_and_bound_solver_id_.has_value() && has_binary_variables_)
+		return branch_and_bound_lower_bound_;
+	if (get_solve_status() == SolveStatus::kOptimal) return get_cost();
+	if (result_.get_solver_id() == drake::solvers::GurobiSolver::id())
+		return result_.get_solver_details<drake::solvers::GurobiSolver>().objective_bound;
+
+	return -std::numeric_limits<double>::infinity();
 }
 
 Eigen::VectorX<double> MISOSProblem::eval(double t)
@@ -321,25 +1136,13 @@ Eigen::VectorX<double> MISOSProblem::eval(double t)
 
 Eigen::VectorX<double> MISOSProblem::eval_derivative(double t, int degree)
 {
-	assert(t < num_traj_segments_);
 	assert(degree <= continuity_degree_);
+	return trajectory_.eval_derivative(t, degree);
+}
 
-	int traj_index = 0;
-	while ((double) traj_index + 1 < t) ++traj_index;
-
-	double t_rel = t - (double) traj_index;
-
-	Eigen::VectorX<double> val(num_vars_);
-	drake::symbolic::Environment at_t {{t_, t_rel}};
-	for (int i = 0; i < num_vars_; ++i)
-	{
-		if (degree == 0)
-			val(i) = polynomials_(i, traj_index).Evaluate(at_t);
-		else
-			val(i) = polynomial_derivatives_[degree - 1](i, traj_index).Evaluate(at_t);
-	}
-
-	return val;
+const SolvedTrajectory& MISOSProblem::get_trajectory()
+{
+	return trajectory_;
 }
 
 } // Namespace trajopt
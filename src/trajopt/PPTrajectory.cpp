@@ -150,9 +150,19 @@ void PPTrajectory::add_constraint(
 	prog_.AddLinearConstraint(val, lb, ub);
 }
 
+void PPTrajectory::set_solver_id(const drake::solvers::SolverId& solver_id)
+{
+	solver_id_ = solver_id;
+}
+
 void PPTrajectory::generate()
 {
-	result_ = Solve(prog_);
+	if (solver_id_.has_value())
+		drake::solvers::MakeSolver(*solver_id_)->Solve(
+				prog_, std::nullopt, std::nullopt, &result_
+				);
+	else
+		result_ = Solve(prog_);
 	//assert(result_.is_success());
 	std::cout << "Solver id: " << result_.get_solver_id() << std::endl;
 	std::cout << "Found solution: " << result_.is_success() << std::endl;
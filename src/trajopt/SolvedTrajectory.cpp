@@ -0,0 +1,231 @@
+#include "trajopt/SolvedTrajectory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <Eigen/LU>
+
+namespace trajopt
+{
+
+SolvedTrajectory::SolvedTrajectory()
+	: num_vars_(0),
+		degree_(0),
+		num_segments_(0),
+		uniform_segments_(true),
+		segment_duration_(1.0),
+		breaks_({ 0.0 })
+{}
+
+SolvedTrajectory::SolvedTrajectory(const std::vector<Eigen::MatrixXd>& segment_coeffs)
+	: SolvedTrajectory(segment_coeffs, [&]()
+			{
+				std::vector<double> breaks(segment_coeffs.size() + 1);
+				for (int j = 0; j < (int) breaks.size(); ++j) breaks[j] = j;
+				return breaks;
+			}())
+{}
+
+SolvedTrajectory::SolvedTrajectory(
+		const std::vector<Eigen::MatrixXd>& segment_coeffs,
+		const std::vector<double>& breaks
+		)
+	: num_vars_(segment_coeffs.front().rows()),
+		degree_(segment_coeffs.front().cols() - 1),
+		num_segments_(segment_coeffs.size()),
+		breaks_(breaks)
+{
+	assert((int) breaks_.size() == num_segments_ + 1);
+
+	const int num_coeffs = degree_ + 1;
+	coeffs_.resize(num_segments_ * num_vars_ * num_coeffs);
+	for (int j = 0; j < num_segments_; ++j)
+	{
+		assert(segment_coeffs[j].rows() == num_vars_);
+		assert(segment_coeffs[j].cols() == num_coeffs);
+		for (int i = 0; i < num_vars_; ++i)
+			for (int n = 0; n < num_coeffs; ++n)
+				coeffs_[(j * num_vars_ + i) * num_coeffs + n] = segment_coeffs[j](i, n);
+	}
+
+	derivative_factors_.resize(num_coeffs * num_coeffs);
+	for (int k = 0; k < num_coeffs; ++k)
+		for (int n = 0; n < num_coeffs; ++n)
+			derivative_factors_[k * num_coeffs + n] = derivative_factor(n, k);
+
+	// Segment lookup is O(1) for equal segment durations,
+	// and a binary search over the breaks otherwise
+	segment_duration_ = (breaks_.back() - breaks_.front()) / num_segments_;
+	uniform_segments_ = true;
+	for (int j = 0; j < num_segments_; ++j)
+	{
+		double duration = breaks_[j + 1] - breaks_[j];
+		assert(duration > 0);
+		if (std::abs(duration - segment_duration_) > 1e-12 * segment_duration_)
+			uniform_segments_ = false;
+	}
+}
+
+int SolvedTrajectory::find_segment(double t) const
+{
+	assert(num_segments_ > 0);
+	int j;
+	if (uniform_segments_)
+		j = (int) std::floor((t - breaks_.front()) / segment_duration_);
+	else
+		j = std::upper_bound(breaks_.begin(), breaks_.end(), t) - breaks_.begin() - 1;
+
+	// Times outside the trajectory are evaluated on the first and last segment
+	return std::clamp(j, 0, num_segments_ - 1);
+}
+
+const double* SolvedTrajectory::segment_coeffs_ptr(int segment_number, int var) const
+{
+	return coeffs_.data() + (segment_number * num_vars_ + var) * (degree_ + 1);
+}
+
+// Evaluates (d/dt)^derivative_order of one polynomial using Horner's method
+double SolvedTrajectory::horner(const double* c, int derivative_order, double t_rel) const
+{
+	const double* factors = derivative_factors_.data() + derivative_order * (degree_ + 1);
+	double val = 0.0;
+	for (int n = degree_; n >= derivative_order; --n)
+		val = val * t_rel + c[n] * factors[n];
+	return val;
+}
+
+Eigen::VectorXd SolvedTrajectory::eval(double t) const
+{
+	return eval_derivative(t, 0);
+}
+
+Eigen::VectorXd SolvedTrajectory::eval_derivative(double t, int derivative_order) const
+{
+	Eigen::VectorXd val = Eigen::VectorXd::Zero(num_vars_);
+	if (derivative_order > degree_) return val;
+
+	const int j = find_segment(t);
+	const double t_rel = t - breaks_[j];
+	for (int i = 0; i < num_vars_; ++i)
+		val(i) = horner(segment_coeffs_ptr(j, i), derivative_order, t_rel);
+
+	return val;
+}
+
+Eigen::MatrixXd SolvedTrajectory::eval_all_derivatives(double t) const
+{
+	Eigen::MatrixXd out(num_vars_, degree_ + 1);
+	eval_all_derivatives(t, out);
+	return out;
+}
+
+void SolvedTrajectory::eval_all_derivatives(double t, Eigen::Ref<Eigen::MatrixXd> out) const
+{
+	assert(out.rows() == num_vars_ && out.cols() == degree_ + 1);
+
+	const int j = find_segment(t);
+	const double t_rel = t - breaks_[j];
+	for (int i = 0; i < num_vars_; ++i)
+	{
+		const double* c = segment_coeffs_ptr(j, i);
+		for (int k = 0; k < degree_ + 1; ++k)
+			out(i, k) = horner(c, k, t_rel);
+	}
+}
+
+void SolvedTrajectory::eval_batch(
+		const Eigen::Ref<const Eigen::VectorXd>& times,
+		TrajectorySamples* samples
+		) const
+{
+	assert(samples->num_vars == num_vars_);
+	assert(samples->num_samples() == times.size());
+
+	const int num_samples = times.size();
+	int start = 0;
+	while (start < num_samples)
+	{
+		// Find the run of samples on the same segment
+		const int j = find_segment(times(start));
+		int end = start + 1;
+		while (end < num_samples && find_segment(times(end)) == j) ++end;
+
+		const int len = end - start;
+		const auto t_rel = times.segment(start, len).array() - breaks_[j];
+
+		// Horner steps on whole arrays of samples, which Eigen
+		// vectorizes with the SIMD instructions enabled at compile time
+		for (int k = 0; k <= samples->max_derivative_order; ++k)
+			for (int i = 0; i < num_vars_; ++i)
+			{
+				auto out = samples->get(k, i).segment(start, len).array();
+				if (k > degree_)
+				{
+					out.setZero();
+					continue;
+				}
+
+				const double* c = segment_coeffs_ptr(j, i);
+				const double* factors = derivative_factors_.data() + k * (degree_ + 1);
+				out.setConstant(c[degree_] * factors[degree_]);
+				for (int n = degree_ - 1; n >= k; --n)
+					out = out * t_rel + c[n] * factors[n];
+			}
+
+		start = end;
+	}
+}
+
+Eigen::MatrixXd SolvedTrajectory::get_segment_coeffs(int segment_number) const
+{
+	Eigen::MatrixXd c(num_vars_, degree_ + 1);
+	for (int i = 0; i < num_vars_; ++i)
+		c.row(i) = Eigen::Map<const Eigen::RowVectorXd>(
+				segment_coeffs_ptr(segment_number, i), degree_ + 1
+				);
+	return c;
+}
+
+SolvedTrajectory shift_trajectory(
+		const SolvedTrajectory& traj,
+		double time_shift,
+		const std::vector<double>& breaks
+		)
+{
+	const int num_coeffs = traj.get_degree() + 1;
+
+	// Interpolation in s = (t - t_j) / T_j on [0, 1], which keeps the
+	// Vandermonde matrix well conditioned for any segment duration
+	Eigen::VectorXd s(num_coeffs);
+	for (int m = 0; m < num_coeffs; ++m)
+		s(m) = (1 - std::cos(M_PI * (m + 0.5) / num_coeffs)) / 2;
+	Eigen::MatrixXd V(num_coeffs, num_coeffs);
+	for (int m = 0; m < num_coeffs; ++m)
+		for (int n = 0; n < num_coeffs; ++n)
+			V(m, n) = std::pow(s(m), n);
+	const Eigen::PartialPivLU<Eigen::MatrixXd> V_lu(V);
+
+	std::vector<Eigen::MatrixXd> segment_coeffs;
+	for (int j = 0; j < (int) breaks.size() - 1; ++j)
+	{
+		const double duration = breaks[j + 1] - breaks[j];
+		Eigen::MatrixXd samples(num_coeffs, traj.get_num_vars());
+		for (int m = 0; m < num_coeffs; ++m)
+		{
+			const double t = std::min(
+					breaks[j] + s(m) * duration + time_shift, traj.get_end_time()
+					);
+			samples.row(m) = traj.eval(t).transpose();
+		}
+
+		// Back to the local time t - t_j
+		Eigen::MatrixXd coeffs = V_lu.solve(samples).transpose();
+		for (int n = 0; n < num_coeffs; ++n)
+			coeffs.col(n) /= std::pow(duration, n);
+		segment_coeffs.push_back(coeffs);
+	}
+
+	return SolvedTrajectory(segment_coeffs, breaks);
+}
+
+} // namespace trajopt
@@ -0,0 +1,771 @@
+#include "trajopt/planner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace trajopt
+{
+
+double elapsed_ms(std::chrono::high_resolution_clock::time_point start)
+{
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::ostream& operator<<(std::ostream& os, const PlanTimings& timings)
+{
+	os << "graph search: " << timings.graph_search << " ms, "
+		<< "relaxation: " << timings.relaxation << " ms, "
+		<< "MIP build: " << timings.mip_build << " ms, "
+		<< "MIP solve: " << timings.mip_solve << " ms, "
+		<< "fixed build: " << timings.fixed_build << " ms, "
+		<< "fixed solve: " << timings.fixed_solve << " ms, "
+		<< "time allocation: " << timings.time_allocation << " ms, "
+		<< "total: " << timings.total << " ms";
+	return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const PlanStatus& status)
+{
+	switch (status)
+	{
+		case PlanStatus::kOptimal: os << "optimal"; break;
+		case PlanStatus::kFeasible: os << "feasible"; break;
+		case PlanStatus::kHeuristic: os << "heuristic"; break;
+		case PlanStatus::kFailed: os << "failed"; break;
+	}
+	return os;
+}
+
+// Relative gap between a cost and a lower bound on the optimal cost
+double calc_mip_gap(double cost, double lower_bound)
+{
+	if (!std::isfinite(lower_bound)) return std::numeric_limits<double>::quiet_NaN();
+	return std::max(0.0, cost - lower_bound) / std::max(std::abs(cost), 1e-9);
+}
+
+// With share_bounds_facets, the workspace box facets are removed from each
+// region and returned as shared halfspaces instead
+std::shared_ptr<const PreparedRegions> prepare_regions(
+		const std::vector<Eigen::MatrixXd>& As,
+		const std::vector<Eigen::VectorXd>& bs,
+		const Eigen::VectorXd& workspace_lower,
+		const Eigen::VectorXd& workspace_upper,
+		bool share_bounds_facets,
+		bool use_tight_big_M
+		)
+{
+	auto regions = std::make_shared<PreparedRegions>();
+	regions->As = As;
+	regions->bs = bs;
+	if (workspace_lower.size() == 0) return regions;
+
+	if (share_bounds_facets)
+	{
+		for (int r = 0; r < (int) As.size(); ++r)
+		{
+			normalize_halfspaces(&regions->As[r], &regions->bs[r]);
+			remove_box_facets(
+					workspace_lower, workspace_upper, &regions->As[r], &regions->bs[r]
+					);
+		}
+		get_box_halfspaces(
+				workspace_lower, workspace_upper, &regions->shared_A, &regions->shared_b
+				);
+	}
+
+	if (use_tight_big_M)
+	{
+		for (int r = 0; r < (int) As.size(); ++r)
+			regions->big_M.push_back(calc_tight_big_M(
+						regions->As[r], regions->bs[r],
+						workspace_lower, workspace_upper, kVehicleRadius
+						));
+		if (share_bounds_facets)
+			regions->big_M.push_back(calc_tight_big_M(
+						regions->shared_A, regions->shared_b,
+						workspace_lower, workspace_upper, kVehicleRadius
+						));
+	}
+
+	return regions;
+}
+
+void add_safe_regions(MISOSProblem* prog, const PreparedRegions& regions)
+{
+	prog->add_convex_regions(regions.As, regions.bs);
+	if (regions.shared_A.rows() > 0)
+		prog->add_shared_halfspaces(regions.shared_A, regions.shared_b);
+	if (!regions.big_M.empty())
+		prog->set_big_M(regions.big_M);
+}
+
+Planner::Planner(
+		std::vector<Eigen::MatrixXd> safe_region_As,
+		std::vector<Eigen::VectorXd> safe_region_bs
+		)
+	: Planner(safe_region_As, safe_region_bs, PlannerOptions())
+{}
+
+Planner::Planner(
+		std::vector<Eigen::MatrixXd> safe_region_As,
+		std::vector<Eigen::VectorXd> safe_region_bs,
+		PlannerOptions options
+		)
+	: safe_region_As_(safe_region_As),
+		safe_region_bs_(safe_region_bs),
+		options_(options),
+		region_graph_(load_or_build_region_graph(
+					safe_region_As, safe_region_bs, kVehicleRadius, options.region_graph_cache_dir
+					)),
+		portfolio_threads_(std::make_shared<PortfolioThreads>())
+{
+	assert(options_.mip_degree <= options_.degree);
+	bool races_branch_and_bound = options_.branch_and_bound_solver_id.has_value();
+	for (const PortfolioConfig& config : options_.portfolio)
+		races_branch_and_bound |= config.branch_and_bound_solver_id.has_value();
+	if (options_.portfolio.size() > 1 && races_branch_and_bound)
+		throw std::invalid_argument(
+				"A portfolio cannot race Drake's branch-and-bound, which has no time limit"
+				);
+	update_prepared_regions();
+}
+
+void Planner::set_workspace_bounds(
+		const Eigen::VectorXd& lower, const Eigen::VectorXd& upper
+		)
+{
+	workspace_lower_ = lower;
+	workspace_upper_ = upper;
+	update_prepared_regions();
+}
+
+// Without the workspace facets, most regions are unbounded. In the convex hull
+// formulation, the coefficient copies of unselected regions are then only
+// forced to zero along bounded directions, so the hull formulation always
+// keeps the workspace facets in each region.
+void Planner::update_prepared_regions()
+{
+	prepared_regions_ = prepare_regions(
+			safe_region_As_, safe_region_bs_, workspace_lower_, workspace_upper_,
+			options_.share_bounds_facets, options_.use_tight_big_M
+			);
+	hull_regions_ = !options_.share_bounds_facets ? prepared_regions_
+		: prepare_regions(
+				safe_region_As_, safe_region_bs_, workspace_lower_, workspace_upper_,
+				false, options_.use_tight_big_M
+				);
+}
+
+PlanResult Planner::plan(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		int num_traj_segments
+		) const
+{
+	PlanResult result;
+	auto plan_start = std::chrono::high_resolution_clock::now();
+
+	if (options_.use_graph_seed && !options_.require_optimal
+			&& plan_from_graph_seed(init_pos, final_pos, num_traj_segments, &result))
+	{
+		allocate_time(init_pos, final_pos, &result);
+		result.timings.total = elapsed_ms(plan_start);
+		return result;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	Eigen::MatrixX<int> rounded_assignments;
+	if (options_.use_relaxation_rounding)
+	{
+		rounded_assignments =
+			get_rounded_assignments(init_pos, final_pos, num_traj_segments);
+		result.timings.relaxation = elapsed_ms(start);
+
+		if (rounded_assignments.size() > 0 && !options_.require_optimal
+				&& solve_fixed_assignment(
+					init_pos, final_pos, rounded_assignments, nullptr,
+					&result.timings, &result.trajectory
+					))
+		{
+			result.region_assignments = rounded_assignments;
+			result.status = PlanStatus::kHeuristic;
+			allocate_time(init_pos, final_pos, &result);
+			result.timings.total = elapsed_ms(plan_start);
+			return result;
+		}
+	}
+
+	std::vector<PortfolioConfig> configs = options_.portfolio;
+	if (configs.empty())
+		configs.push_back(get_default_config(num_traj_segments));
+	problem_factory_t make_mip =
+		get_mip_factory(init_pos, final_pos, rounded_assignments);
+
+	// Find region assignments with the mixed-integer problem.
+	// Without any, the plan fails with the timings so far.
+	auto fail = [&]()
+	{
+		result.status = PlanStatus::kFailed;
+		result.region_assignments.resize(0, 0);
+		result.timings.total = elapsed_ms(plan_start);
+		return result;
+	};
+	SolvedTrajectory mip_traj;
+	int config_index = 0;
+	start = std::chrono::high_resolution_clock::now();
+	if (configs.size() == 1 && options_.use_region_branch_and_bound)
+	{
+		std::vector<int> first_regions;
+		if (options_.use_region_graph)
+			first_regions = region_graph_->get_regions_containing(init_pos);
+		else
+			for (int r = 0; r < region_graph_->get_num_regions(); ++r)
+				first_regions.push_back(r);
+
+		RegionBranchAndBound bnb(
+				configs[0], make_mip,
+				options_.use_region_graph ? region_graph_.get() : nullptr,
+				region_graph_->get_num_regions(), options_.region_branch_and_bound
+				);
+		RegionBranchAndBoundResult bnb_result = bnb.solve(first_regions);
+		result.timings.mip_solve = elapsed_ms(start);
+		if (!bnb_result.success) return fail();
+		mip_traj = bnb_result.trajectory;
+		result.region_assignments = bnb_result.region_assignments;
+		result.status = bnb_result.optimal
+			? PlanStatus::kOptimal : PlanStatus::kFeasible;
+		result.mip_gap = calc_mip_gap(bnb_result.cost, bnb_result.lower_bound);
+	}
+	else if (configs.size() == 1)
+	{
+		std::unique_ptr<MISOSProblem> mip = make_mip(configs[0]);
+		result.timings.mip_build = elapsed_ms(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		const bool success = mip->try_generate(&mip_traj);
+		result.timings.mip_solve = elapsed_ms(start);
+		if (!success) return fail();
+		result.region_assignments = mip->get_region_assignments();
+		result.status = mip->get_solve_status() == SolveStatus::kOptimal
+			? PlanStatus::kOptimal : PlanStatus::kFeasible;
+	}
+	else
+	{
+		// Build and solve times overlap between the threads,
+		// and are both counted as solve time
+		PortfolioResult race =
+			solve_first_of(configs, make_mip, portfolio_threads_.get());
+		result.timings.mip_solve = elapsed_ms(start);
+		if (!race.success) return fail();
+		std::cout << "Portfolio configuration " << race.config_index
+			<< " finished first" << std::endl;
+		config_index = race.config_index;
+		mip_traj = race.trajectory;
+		result.region_assignments = race.region_assignments;
+		result.status = race.solve_status == SolveStatus::kOptimal
+			? PlanStatus::kOptimal : PlanStatus::kFeasible;
+	}
+
+	if (is_single_stage(configs[config_index]))
+	{
+		result.trajectory = mip_traj;
+		allocate_time(init_pos, final_pos, &result);
+		result.timings.total = elapsed_ms(plan_start);
+		return result;
+	}
+
+	if (!solve_fixed_assignment(
+				init_pos, final_pos, result.region_assignments, &mip_traj,
+				&result.timings, &result.trajectory
+				))
+		return fail();
+	allocate_time(init_pos, final_pos, &result);
+	result.timings.total = elapsed_ms(plan_start);
+
+	return result;
+}
+
+PlanResult Planner::plan_anytime(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		int num_traj_segments,
+		double time_budget_ms
+		) const
+{
+	PlanResult result;
+	auto plan_start = std::chrono::high_resolution_clock::now();
+	auto remaining_s = [&]()
+	{
+		return std::max(0.0, time_budget_ms - elapsed_ms(plan_start)) / 1000.0;
+	};
+
+	// Cheap fallback, only solved if there is no incumbent at the deadline
+	auto start = std::chrono::high_resolution_clock::now();
+	Eigen::MatrixX<int> fallback_assignments =
+		get_graph_seed_assignments(init_pos, final_pos, num_traj_segments);
+	result.timings.graph_search = elapsed_ms(start);
+
+	PortfolioConfig config = get_default_config(num_traj_segments);
+	problem_factory_t make_mip =
+		get_mip_factory(init_pos, final_pos, Eigen::MatrixX<int>());
+	const double mip_time_limit = options_.anytime_mip_fraction * remaining_s();
+
+	start = std::chrono::high_resolution_clock::now();
+	std::unique_ptr<MISOSProblem> mip = make_mip(config);
+	mip->set_time_limit(mip_time_limit);
+	result.timings.mip_build = elapsed_ms(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	SolvedTrajectory mip_traj;
+	const bool has_incumbent = mip->try_generate(&mip_traj);
+	result.timings.mip_solve = elapsed_ms(start);
+
+	// The mixed-integer trajectory is only kept in a single stage, as the
+	// low degree trajectory has no snap for the controller
+	bool planned = false;
+	if (has_incumbent)
+	{
+		result.region_assignments = mip->get_region_assignments();
+		if (is_single_stage(config))
+		{
+			result.trajectory = mip_traj;
+			planned = true;
+		}
+		else
+			planned = solve_fixed_assignment(
+					init_pos, final_pos, result.region_assignments, &mip_traj,
+					remaining_s(), &result.timings, &result.trajectory
+					);
+	}
+
+	if (planned)
+	{
+		if (mip->get_solve_status() == SolveStatus::kOptimal)
+		{
+			result.status = PlanStatus::kOptimal;
+			result.mip_gap = 0;
+		}
+		else
+		{
+			result.status = PlanStatus::kFeasible;
+
+			// If the solver reports no bound, the root relaxation gives one for the
+			// MIP gap, solved with what is left of the budget. The branch-and-bound
+			// backend always reports a bound, and would ignore the time limit.
+			double lower_bound = mip->get_lower_bound();
+			if (!std::isfinite(lower_bound) && remaining_s() > 0
+					&& !options_.branch_and_bound_solver_id.has_value())
+			{
+				PortfolioConfig root_config = config;
+				root_config.relax_binaries = true;
+				std::unique_ptr<MISOSProblem> root = make_mip(root_config);
+				root->set_time_limit(remaining_s());
+				SolvedTrajectory root_traj;
+				if (root->try_generate(&root_traj)
+						&& root->get_solve_status() == SolveStatus::kOptimal)
+					lower_bound = root->get_cost();
+			}
+			result.mip_gap = calc_mip_gap(mip->get_cost(), lower_bound);
+		}
+	}
+	else if (fallback_assignments.size() > 0
+			&& solve_fixed_assignment(
+				init_pos, final_pos, fallback_assignments, nullptr,
+				remaining_s(), &result.timings, &result.trajectory
+				))
+	{
+		std::cout << "No trajectory from the mixed-integer assignments within "
+			<< "the time budget, using the graph search assignments" << std::endl;
+		result.region_assignments = fallback_assignments;
+		result.status = PlanStatus::kHeuristic;
+	}
+	else
+	{
+		result.region_assignments.resize(0, 0);
+		result.status = PlanStatus::kFailed;
+	}
+
+	result.timings.total = elapsed_ms(plan_start);
+	return result;
+}
+
+PlanResult Planner::plan_auto_segments(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		int max_num_traj_segments
+		) const
+{
+	PlanResult result;
+	auto plan_start = std::chrono::high_resolution_clock::now();
+
+	const int min_num_segments = get_min_num_segments(init_pos, final_pos);
+	if (min_num_segments == -1)
+	{
+		std::cout << "No region sequence from start to goal" << std::endl;
+		result.timings.total = elapsed_ms(plan_start);
+		return result;
+	}
+
+	for (int num_traj_segments = min_num_segments;
+			num_traj_segments <= max_num_traj_segments; ++num_traj_segments)
+	{
+		std::cout << "Trying " << num_traj_segments << " segments" << std::endl;
+		if (options_.use_graph_seed && !options_.require_optimal
+				&& plan_from_graph_seed(init_pos, final_pos, num_traj_segments, &result))
+			break;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		Eigen::MatrixX<int> assignments_guess =
+			get_graph_seed_assignments(init_pos, final_pos, num_traj_segments);
+		PortfolioConfig config = get_default_config(num_traj_segments);
+		std::unique_ptr<MISOSProblem> mip =
+			get_mip_factory(init_pos, final_pos, assignments_guess)(config);
+		result.timings.mip_build += elapsed_ms(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		SolvedTrajectory mip_traj;
+		const bool feasible = mip->try_generate(&mip_traj);
+		result.timings.mip_solve += elapsed_ms(start);
+		if (!feasible) continue;
+
+		// The low degree trajectory lacks the higher derivatives,
+		// so a failed fixed assignment stage counts as a failed step
+		const Eigen::MatrixX<int> assignments = mip->get_region_assignments();
+		if (is_single_stage(config))
+			result.trajectory = mip_traj;
+		else if (!solve_fixed_assignment(
+					init_pos, final_pos, assignments, &mip_traj,
+					&result.timings, &result.trajectory
+					))
+			continue;
+
+		result.region_assignments = assignments;
+		result.status = mip->get_solve_status() == SolveStatus::kOptimal
+			? PlanStatus::kOptimal : PlanStatus::kFeasible;
+		break;
+	}
+
+	allocate_time(init_pos, final_pos, &result);
+	result.timings.total = elapsed_ms(plan_start);
+	return result;
+}
+
+// Each region on the sequence needs at least one segment
+int Planner::get_min_num_segments(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos
+		) const
+{
+	auto start_regions = region_graph_->get_regions_containing(init_pos);
+	auto goal_regions = region_graph_->get_regions_containing(final_pos);
+	if (start_regions.empty() || goal_regions.empty()) return -1;
+
+	auto dist_from_start = region_graph_->get_distances(start_regions);
+	int min_dist = -1;
+	for (int r : goal_regions)
+		if (dist_from_start[r] != -1 && (min_dist == -1 || dist_from_start[r] < min_dist))
+			min_dist = dist_from_start[r];
+
+	return min_dist == -1 ? -1 : min_dist + 1;
+}
+
+// Linear control point constraints allow the mixed-integer problem
+// to be solved directly at the final degree
+bool Planner::is_single_stage(const PortfolioConfig& config)
+{
+	return config.region_containment == RegionContainment::kControlPoints;
+}
+
+PortfolioConfig Planner::get_default_config(int num_traj_segments) const
+{
+	PortfolioConfig config;
+	config.num_traj_segments = num_traj_segments;
+	config.region_formulation = options_.region_formulation;
+	config.region_containment = options_.region_containment;
+	return config;
+}
+
+// The factory only holds copies of the planner data,
+// so that portfolio threads may outlive the planner
+problem_factory_t Planner::get_mip_factory(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		const Eigen::MatrixX<int>& assignments_guess
+		) const
+{
+	std::shared_ptr<const RegionGraph> region_graph;
+	if (options_.use_region_graph)
+		region_graph = region_graph_;
+
+	return [
+		init_pos, final_pos, assignments_guess, region_graph,
+		regions = prepared_regions_, hull_regions = hull_regions_, options = options_
+	](const PortfolioConfig& config)
+	{
+		const bool single_stage = is_single_stage(config);
+		auto mip = std::make_unique<MISOSProblem>(
+				config.num_traj_segments, options.num_vars,
+				single_stage ? options.degree : options.mip_degree,
+				single_stage ? options.continuity_degree : options.mip_continuity_degree,
+				init_pos, final_pos
+				);
+		mip->set_region_containment(config.region_containment);
+		mip->set_region_formulation(config.region_formulation);
+		mip->set_monotone_region_order(options.monotone_region_order);
+		mip->set_no_return_cuts(options.no_return_cuts);
+		if (options.lazy_region_constraints
+				&& config.region_formulation == RegionFormulation::kBigM)
+			mip->set_lazy_region_constraints(true);
+		if (config.solver_id.has_value())
+			mip->set_solver_id(*config.solver_id);
+		if (config.branch_and_bound_solver_id.has_value())
+			mip->set_branch_and_bound(*config.branch_and_bound_solver_id);
+		else if (options.branch_and_bound_solver_id.has_value())
+			mip->set_branch_and_bound(*options.branch_and_bound_solver_id);
+		if (options.portfolio.size() > 1)
+			mip->set_time_limit(options.portfolio_time_limit);
+		mip->set_verbose(options.verbose);
+		add_safe_regions(
+				mip.get(),
+				config.region_formulation == RegionFormulation::kConvexHull
+					? *hull_regions : *regions
+				);
+		if (region_graph != nullptr)
+			mip->add_region_graph(region_graph.get());
+		mip->set_fixed_region_prefix(config.fixed_region_prefix);
+		mip->create_region_binary_variables(config.relax_binaries);
+		if (!config.relax_binaries
+				&& assignments_guess.cols() == config.num_traj_segments)
+			mip->set_initial_guess(assignments_guess);
+		return mip;
+	};
+}
+
+// Only the convex fixed assignment problem is solved, with the segments
+// distributed over the regions along the shortest path
+bool Planner::plan_from_graph_seed(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		int num_traj_segments,
+		PlanResult* result
+		) const
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	Eigen::MatrixX<int> assignments =
+		get_graph_seed_assignments(init_pos, final_pos, num_traj_segments);
+	result->timings.graph_search = elapsed_ms(start);
+
+	if (assignments.size() == 0)
+	{
+		std::cout << "No region path with at most " << num_traj_segments
+			<< " regions, solving MIP" << std::endl;
+		return false;
+	}
+
+	if (!solve_fixed_assignment(
+				init_pos, final_pos, assignments, nullptr,
+				&result->timings, &result->trajectory
+				))
+	{
+		std::cout << "Graph seeded assignments infeasible, solving MIP" << std::endl;
+		return false;
+	}
+
+	result->region_assignments = assignments;
+	result->status = PlanStatus::kHeuristic;
+	return true;
+}
+
+// Solves the mixed-integer problem with H relaxed to [0, 1], and rounds the
+// region weights of each segment along the region graph.
+// Empty if the relaxation is infeasible or cannot be rounded.
+Eigen::MatrixX<int> Planner::get_rounded_assignments(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		int num_traj_segments
+		) const
+{
+	PortfolioConfig config = get_default_config(num_traj_segments);
+	config.relax_binaries = true;
+	std::unique_ptr<MISOSProblem> relaxation =
+		get_mip_factory(init_pos, final_pos, Eigen::MatrixX<int>())(config);
+
+	SolvedTrajectory relaxed_traj;
+	if (!relaxation->try_generate(&relaxed_traj)) return Eigen::MatrixX<int>();
+
+	return region_graph_->round_region_weights(
+			relaxation->get_region_weights(), init_pos, final_pos
+			);
+}
+
+// Empty if there is no path through at most num_traj_segments regions
+Eigen::MatrixX<int> Planner::get_graph_seed_assignments(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		int num_traj_segments
+		) const
+{
+	RegionPath path;
+	if (!region_graph_->find_shortest_path(init_pos, final_pos, &path))
+		return Eigen::MatrixX<int>();
+
+	return get_region_assignments_along_path(
+			path, region_graph_->get_num_regions(), num_traj_segments
+			);
+}
+
+bool Planner::solve_fixed_assignment(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		const Eigen::MatrixX<int>& region_assignments,
+		const std::vector<double>& segment_durations,
+		const SolvedTrajectory* initial_guess,
+		double time_limit,
+		PlanTimings* timings,
+		SolvedTrajectory* traj
+		) const
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	std::unique_ptr<MISOSProblem> prog = make_fixed_assignment_problem(
+			init_pos, final_pos, region_assignments, segment_durations
+			);
+	if (initial_guess != nullptr)
+		prog->set_initial_guess(*initial_guess);
+	if (std::isfinite(time_limit))
+		prog->set_time_limit(time_limit);
+	timings->fixed_build = elapsed_ms(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	bool success = prog->try_generate(traj);
+	timings->fixed_solve = elapsed_ms(start);
+
+	return success;
+}
+
+std::unique_ptr<MISOSProblem> Planner::make_fixed_assignment_problem(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		const Eigen::MatrixX<int>& region_assignments,
+		const std::vector<double>& segment_durations
+		) const
+{
+	auto prog = std::make_unique<MISOSProblem>(
+			region_assignments.cols(), options_.num_vars,
+			options_.degree, options_.continuity_degree,
+			init_pos, final_pos, segment_durations
+			);
+	prog->set_region_containment(options_.region_containment);
+	if (options_.branch_and_bound_solver_id.has_value())
+		prog->set_solver_id(*options_.branch_and_bound_solver_id);
+	prog->set_verbose(options_.verbose);
+	add_safe_regions(prog.get(), *prepared_regions_);
+	prog->add_safe_region_assignments(region_assignments);
+	return prog;
+}
+
+void Planner::allocate_time(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		PlanResult* result
+		) const
+{
+	if (!options_.optimize_time_allocation || result->status == PlanStatus::kFailed)
+		return;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	SolvedTrajectory traj;
+	if (optimize_time_allocation(
+				init_pos, final_pos, result->region_assignments, result->trajectory, &traj
+				))
+		result->trajectory = traj;
+	result->timings.time_allocation = elapsed_ms(start);
+}
+
+// The flight time for given relative segment durations is found by solving the
+// fixed assignment problem with these durations, and scaling the solution to
+// the fastest speed within the dynamic limits. The scaling does not change the
+// path, which stays in the regions. The relative durations are optimized in
+// log space along finite difference gradients of the flight time, with a
+// golden-section line search. All evaluations solve one program, with the
+// segment durations updated in place.
+bool Planner::optimize_time_allocation(
+		const Eigen::VectorXd& init_pos,
+		const Eigen::VectorXd& final_pos,
+		const Eigen::MatrixX<int>& region_assignments,
+		const SolvedTrajectory& initial_guess,
+		SolvedTrajectory* traj
+		) const
+{
+	const int samples_per_segment = 20;
+	const double gradient_step = 0.05;
+	const double max_line_step = 1.0;
+	const int line_search_iterations = 6;
+
+	const int num_traj_segments = region_assignments.cols();
+	std::unique_ptr<MISOSProblem> prog = make_fixed_assignment_problem(
+			init_pos, final_pos, region_assignments,
+			std::vector<double>(num_traj_segments, 1.0)
+			);
+	auto flight_time = [&](const Eigen::VectorXd& log_durations, SolvedTrajectory* scaled)
+	{
+		std::vector<double> durations(num_traj_segments);
+		for (int j = 0; j < num_traj_segments; ++j)
+			durations[j] = std::exp(log_durations(j));
+
+		prog->update_segment_durations(durations);
+		prog->set_initial_guess(initial_guess);
+		SolvedTrajectory solved;
+		if (!prog->try_generate(&solved))
+			return std::numeric_limits<double>::infinity();
+
+		double alpha = calc_min_time_scaling(
+				solved, options_.dynamic_limits, samples_per_segment
+				);
+		if (scaled != nullptr)
+			*scaled = scale_time(solved, alpha);
+		return alpha * solved.get_end_time();
+	};
+
+	Eigen::VectorXd log_durations = Eigen::VectorXd::Zero(num_traj_segments);
+	double best_time = flight_time(log_durations, traj);
+	if (!std::isfinite(best_time)) return false;
+	std::cout << "Flight time with equal segment durations: " << best_time << " s" << std::endl;
+
+	for (int iteration = 0; iteration < options_.time_allocation_iterations; ++iteration)
+	{
+		// Directions that make the problem infeasible are not followed
+		Eigen::VectorXd gradient(num_traj_segments);
+		for (int j = 0; j < num_traj_segments; ++j)
+		{
+			Eigen::VectorXd perturbed = log_durations;
+			perturbed(j) += gradient_step;
+			gradient(j) = (flight_time(perturbed, nullptr) - best_time) / gradient_step;
+			if (!std::isfinite(gradient(j))) gradient(j) = 0;
+		}
+		if (gradient.norm() < 1e-9) break;
+
+		const Eigen::VectorXd direction = -gradient / gradient.norm();
+		const double step = golden_section_search(
+				[&](double s) { return flight_time(log_durations + s * direction, nullptr); },
+				0, max_line_step, line_search_iterations
+				);
+
+		SolvedTrajectory candidate;
+		const double candidate_time = flight_time(log_durations + step * direction, &candidate);
+		if (!(candidate_time < best_time)) break;
+
+		// The flight time does not depend on the scale of the durations,
+		// which are kept around one second
+		log_durations += step * direction;
+		log_durations.array() -= log_durations.mean();
+		best_time = candidate_time;
+		*traj = candidate;
+	}
+
+	std::cout << "Flight time after time allocation: " << best_time << " s" << std::endl;
+	return true;
+}
+
+} // namespace trajopt
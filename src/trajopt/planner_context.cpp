@@ -0,0 +1,74 @@
+#include "trajopt/planner_context.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace trajopt
+{
+
+PlannerContext::PlannerContext(
+		const std::vector<Eigen::MatrixXd>& safe_region_As,
+		const std::vector<Eigen::VectorXd>& safe_region_bs,
+		const Eigen::VectorXd& workspace_lower,
+		const Eigen::VectorXd& workspace_upper
+		)
+	: PlannerContext(
+			safe_region_As, safe_region_bs, workspace_lower, workspace_upper,
+			PlannerOptions(), PlannerContextOptions()
+			)
+{}
+
+PlannerContext::PlannerContext(
+		const std::vector<Eigen::MatrixXd>& safe_region_As,
+		const std::vector<Eigen::VectorXd>& safe_region_bs,
+		const Eigen::VectorXd& workspace_lower,
+		const Eigen::VectorXd& workspace_upper,
+		PlannerOptions planner_options,
+		PlannerContextOptions options
+		)
+	: options_(options),
+		planner_(safe_region_As, safe_region_bs, planner_options)
+{
+	if (workspace_lower.size() > 0)
+		planner_.set_workspace_bounds(workspace_lower, workspace_upper);
+}
+
+PlanResult PlannerContext::plan(const PlanQuery& query) const
+{
+	if (query.num_traj_segments > 0)
+		return planner_.plan(query.init_pos, query.final_pos, query.num_traj_segments);
+
+	return planner_.plan_auto_segments(
+			query.init_pos, query.final_pos, options_.max_num_traj_segments
+			);
+}
+
+std::vector<PlanResult> PlannerContext::plan_batch(
+		const std::vector<PlanQuery>& queries
+		) const
+{
+	int num_threads = options_.num_threads;
+	if (num_threads <= 0)
+		num_threads = std::max(1u, std::thread::hardware_concurrency());
+	num_threads = std::min(num_threads, (int) queries.size());
+
+	// Each result is only written by the thread that took its query
+	std::vector<PlanResult> results(queries.size());
+	std::atomic<int> next_query(0);
+	auto worker = [&]()
+	{
+		for (int q = next_query++; q < (int) queries.size(); q = next_query++)
+			results[q] = plan(queries[q]);
+	};
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++t)
+		threads.emplace_back(worker);
+	for (auto& thread : threads)
+		thread.join();
+
+	return results;
+}
+
+} // namespace trajopt
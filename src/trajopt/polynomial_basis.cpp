@@ -0,0 +1,65 @@
+#include "trajopt/polynomial_basis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Eigenvalues>
+
+namespace trajopt
+{
+
+int factorial(int n)
+{
+	int res = 1;
+	for (int i = 2; i <= n; ++i) res *= i;
+	return res;
+}
+
+static double eval_polynomial(const Eigen::VectorXd& coeffs, double t)
+{
+	double val = 0.0;
+	for (int n = coeffs.size() - 1; n >= 0; --n)
+		val = val * t + coeffs(n);
+	return val;
+}
+
+double min_on_unit_interval(const Eigen::VectorXd& coeffs)
+{
+	double min_val = std::min(
+			eval_polynomial(coeffs, 0.0), eval_polynomial(coeffs, 1.0)
+			);
+
+	// Derivative, without vanishing leading coefficients
+	const double tol = 1e-12 * std::max(1.0, coeffs.cwiseAbs().maxCoeff());
+	int degree = coeffs.size() - 1;
+	while (degree > 0 && std::abs(coeffs(degree)) <= tol) --degree;
+	if (degree < 2) return min_val;
+
+	Eigen::VectorXd derivative(degree);
+	for (int n = 1; n <= degree; ++n)
+		derivative(n - 1) = n * coeffs(n);
+
+	// Roots of the derivative are the eigenvalues of its companion matrix
+	const int num_roots = degree - 1;
+	Eigen::MatrixXd companion = Eigen::MatrixXd::Zero(num_roots, num_roots);
+	companion.bottomLeftCorner(num_roots - 1, num_roots - 1).setIdentity();
+	companion.col(num_roots - 1) = -derivative.head(num_roots) / derivative(num_roots);
+
+	Eigen::EigenSolver<Eigen::MatrixXd> solver(companion, false);
+	for (const auto& root : solver.eigenvalues())
+		if (std::abs(root.imag()) < 1e-9 && root.real() > 0.0 && root.real() < 1.0)
+			min_val = std::min(min_val, eval_polynomial(coeffs, root.real()));
+
+	return min_val;
+}
+
+Eigen::MatrixXd monomial_to_bernstein(int degree)
+{
+	Eigen::MatrixXd T(degree + 1, degree + 1);
+	for (int n = 0; n < degree + 1; ++n)
+		for (int k = 0; k < degree + 1; ++k)
+			T(n,k) = bernstein_factor(degree, n, k);
+
+	return T;
+}
+
+} // namespace trajopt
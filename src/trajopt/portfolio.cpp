@@ -0,0 +1,78 @@
+#include "trajopt/portfolio.h"
+
+#include <condition_variable>
+
+namespace trajopt
+{
+
+PortfolioThreads::~PortfolioThreads()
+{
+	join_all();
+}
+
+void PortfolioThreads::add(std::thread thread)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	threads_.push_back(std::move(thread));
+}
+
+void PortfolioThreads::join_all()
+{
+	std::vector<std::thread> threads;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		threads.swap(threads_);
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+PortfolioResult solve_first_of(
+		const std::vector<PortfolioConfig>& configs,
+		const problem_factory_t& make_problem,
+		PortfolioThreads* threads
+		)
+{
+	// The losers of an earlier race would otherwise pile up
+	threads->join_all();
+
+	// Shared with the solver threads, which may outlive this call
+	struct RaceState
+	{
+		std::mutex mutex;
+		std::condition_variable finished;
+		int num_finished = 0;
+		PortfolioResult result;
+	};
+	auto state = std::make_shared<RaceState>();
+
+	for (int i = 0; i < (int) configs.size(); ++i)
+		threads->add(std::thread([state, make_problem, config = configs[i], i]()
+		{
+			std::unique_ptr<MISOSProblem> prog = make_problem(config);
+			SolvedTrajectory traj;
+			const bool success = prog->try_generate(&traj);
+
+			std::lock_guard<std::mutex> lock(state->mutex);
+			++state->num_finished;
+			if (success && !state->result.success)
+			{
+				state->result.success = true;
+				state->result.config_index = i;
+				state->result.solve_status = prog->get_solve_status();
+				state->result.trajectory = traj;
+				state->result.region_assignments = prog->get_region_assignments();
+			}
+			state->finished.notify_all();
+		}));
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished.wait(lock, [&]()
+	{
+		return state->result.success || state->num_finished == (int) configs.size();
+	});
+
+	return state->result;
+}
+
+} // namespace trajopt
@@ -0,0 +1,234 @@
+#include "trajopt/region_branch_and_bound.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace trajopt
+{
+
+RegionBranchAndBound::RegionBranchAndBound(
+		const PortfolioConfig& config,
+		const problem_factory_t& make_problem,
+		const RegionGraph* region_graph,
+		int num_regions,
+		RegionBranchAndBoundOptions options
+		)
+	: config_(config),
+		make_problem_(make_problem),
+		region_graph_(region_graph),
+		num_regions_(num_regions),
+		options_(options),
+		num_pending_(0),
+		num_pushed_(0),
+		num_nodes_(0),
+		stop_(false)
+{}
+
+RegionBranchAndBoundResult RegionBranchAndBound::solve(
+		const std::vector<int>& first_regions
+		)
+{
+	int num_threads = options_.num_threads;
+	if (num_threads <= 0)
+		num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	queues_.clear();
+	for (int w = 0; w < num_threads; ++w)
+		queues_.push_back(std::make_unique<WorkerQueue>());
+	num_pending_ = 0;
+	num_pushed_ = 0;
+	num_nodes_ = 0;
+	stop_ = false;
+	incumbent_ = RegionBranchAndBoundResult();
+
+	// The root children are spread over the workers
+	for (int k = 0; k < (int) first_regions.size(); ++k)
+		push_node(k % num_threads, {
+				{ first_regions[k] }, -std::numeric_limits<double>::infinity(), nullptr
+				});
+
+	std::vector<std::thread> workers;
+	for (int w = 0; w < num_threads; ++w)
+		workers.emplace_back(&RegionBranchAndBound::run_worker, this, w);
+	for (auto& worker : workers)
+		worker.join();
+
+	RegionBranchAndBoundResult result = incumbent_;
+	result.num_nodes = num_nodes_;
+	result.optimal = result.success && !stop_;
+
+	// Unexplored nodes bound the optimal cost if the search was stopped
+	result.lower_bound = result.cost;
+	for (const auto& queue : queues_)
+		for (const auto& node : queue->nodes)
+			result.lower_bound = std::min(result.lower_bound, node.parent_bound);
+
+	if (options_.verbose)
+		std::cout << "Region branch-and-bound: " << result.num_nodes << " nodes, cost "
+			<< result.cost << ", lower bound " << result.lower_bound << std::endl;
+	return result;
+}
+
+void RegionBranchAndBound::run_worker(int worker)
+{
+	while (!stop_)
+	{
+		int num_pushed;
+		{
+			std::lock_guard<std::mutex> lock(work_mutex_);
+			num_pushed = num_pushed_;
+		}
+
+		Node node;
+		if (pop_node(worker, &node))
+		{
+			process_node(worker, node);
+			finish_node();
+			continue;
+		}
+
+		// Sleep until a node is pushed after the failed pop. Children are pushed
+		// before their parent is counted as done, so no pending nodes means the
+		// tree is exhausted.
+		std::unique_lock<std::mutex> lock(work_mutex_);
+		work_changed_.wait(lock, [&]()
+		{
+			return stop_ || num_pending_ == 0 || num_pushed_ != num_pushed;
+		});
+		if (num_pending_ == 0) return;
+	}
+}
+
+bool RegionBranchAndBound::pop_node(int worker, Node* node)
+{
+	{
+		std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+		auto& nodes = queues_[worker]->nodes;
+		if (!nodes.empty())
+		{
+			*node = std::move(nodes.back());
+			nodes.pop_back();
+			return true;
+		}
+	}
+
+	// Steal the oldest node, which has the largest subtree
+	for (int k = 1; k < (int) queues_.size(); ++k)
+	{
+		auto& victim = *queues_[(worker + k) % queues_.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.nodes.empty())
+		{
+			*node = std::move(victim.nodes.front());
+			victim.nodes.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RegionBranchAndBound::push_node(int worker, Node node)
+{
+	++num_pending_;
+	{
+		std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+		queues_[worker]->nodes.push_back(std::move(node));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(work_mutex_);
+		++num_pushed_;
+	}
+	work_changed_.notify_one();
+}
+
+void RegionBranchAndBound::finish_node()
+{
+	bool wake_all;
+	{
+		std::lock_guard<std::mutex> lock(work_mutex_);
+		wake_all = --num_pending_ == 0 || stop_;
+	}
+	if (wake_all) work_changed_.notify_all();
+}
+
+void RegionBranchAndBound::process_node(int worker, const Node& node)
+{
+	if (node.parent_bound >= get_prune_threshold()) return;
+	if (++num_nodes_ > options_.max_nodes)
+	{
+		stop_ = true;
+		// Kept as unexplored for the lower bound
+		push_node(worker, node);
+		return;
+	}
+
+	PortfolioConfig config = config_;
+	config.relax_binaries = true;
+	config.fixed_region_prefix = node.fixed_regions;
+	std::unique_ptr<MISOSProblem> relaxation = make_problem_(config);
+	if (node.parent_trajectory != nullptr)
+		relaxation->set_initial_guess(*node.parent_trajectory);
+
+	auto trajectory = std::make_shared<SolvedTrajectory>();
+	if (!relaxation->try_generate(trajectory.get())) return;
+	const double cost = relaxation->get_cost();
+	if (cost >= get_prune_threshold()) return;
+
+	// An integral relaxation is the best assignment in the subtree
+	const Eigen::MatrixXd weights = relaxation->get_region_weights();
+	const bool integral =
+		(weights.array() - weights.array().round()).abs().maxCoeff() < 1e-6;
+	if (integral)
+	{
+		update_incumbent(cost, relaxation->get_region_assignments(), *trajectory);
+		return;
+	}
+
+	const int segment = node.fixed_regions.size();
+	const int last_region = node.fixed_regions.back();
+	std::vector<int> children;
+	for (int r = 0; r < num_regions_; ++r)
+		if (region_graph_ == nullptr || r == last_region
+				|| region_graph_->are_neighbours(last_region, r))
+			children.push_back(r);
+
+	// The highest weight child is pushed last, and explored first
+	std::sort(children.begin(), children.end(), [&](int r1, int r2)
+	{
+		return weights(r1, segment) < weights(r2, segment);
+	});
+	for (int r : children)
+	{
+		Node child = { node.fixed_regions, cost, trajectory };
+		child.fixed_regions.push_back(r);
+		push_node(worker, std::move(child));
+	}
+}
+
+double RegionBranchAndBound::get_prune_threshold()
+{
+	std::lock_guard<std::mutex> lock(incumbent_mutex_);
+	if (!incumbent_.success) return std::numeric_limits<double>::infinity();
+	return incumbent_.cost - options_.relative_gap * std::abs(incumbent_.cost);
+}
+
+void RegionBranchAndBound::update_incumbent(
+		double cost,
+		const Eigen::MatrixX<int>& region_assignments,
+		const SolvedTrajectory& trajectory
+		)
+{
+	std::lock_guard<std::mutex> lock(incumbent_mutex_);
+	if (incumbent_.success && cost >= incumbent_.cost) return;
+
+	incumbent_.success = true;
+	incumbent_.cost = cost;
+	incumbent_.region_assignments = region_assignments;
+	incumbent_.trajectory = trajectory;
+}
+
+} // namespace trajopt
@@ -0,0 +1,320 @@
+#include "trajopt/region_graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <cassert>
+#include <functional>
+
+namespace trajopt
+{
+
+RegionGraph::RegionGraph(
+		std::vector<Eigen::MatrixXd> As,
+		std::vector<Eigen::VectorXd> bs,
+		double margin
+		)
+	: num_regions_(As.size()),
+		margin_(margin),
+		As_(As),
+		bs_(bs),
+		neighbours_(As.size()),
+		transition_points_(As.size())
+{
+	Eigen::VectorXd point;
+	for (int r1 = 0; r1 < num_regions_; ++r1)
+		for (int r2 = r1 + 1; r2 < num_regions_; ++r2)
+			if (regions_intersect(r1, r2, &point))
+			{
+				neighbours_[r1].push_back(r2);
+				neighbours_[r2].push_back(r1);
+				transition_points_[r1].push_back(point);
+				transition_points_[r2].push_back(point);
+			}
+}
+
+RegionGraph::RegionGraph(
+		std::vector<Eigen::MatrixXd> As,
+		std::vector<Eigen::VectorXd> bs,
+		double margin,
+		const std::vector<std::pair<int, int>>& edges,
+		const std::vector<Eigen::VectorXd>& transition_points
+		)
+	: num_regions_(As.size()),
+		margin_(margin),
+		As_(As),
+		bs_(bs),
+		neighbours_(As.size()),
+		transition_points_(As.size())
+{
+	assert(edges.size() == transition_points.size());
+	for (int k = 0; k < (int) edges.size(); ++k)
+	{
+		const auto [r1, r2] = edges[k];
+		assert(r1 < r2 && r2 < num_regions_);
+		neighbours_[r1].push_back(r2);
+		neighbours_[r2].push_back(r1);
+		transition_points_[r1].push_back(transition_points[k]);
+		transition_points_[r2].push_back(transition_points[k]);
+	}
+}
+
+// Finds the Chebyshev center x of the intersection shrunk by the margin,
+// by maximizing s subject to
+// A_r1 * x + s * ||a_i|| <= b_r1 - margin, A_r2 * x + s * ||a_i|| <= b_r2 - margin.
+// The regions intersect if this is feasible with s >= 0.
+bool RegionGraph::regions_intersect(int r1, int r2, Eigen::VectorXd* point) const
+{
+	const int dim = As_[r1].cols();
+	const int num_rows = As_[r1].rows() + As_[r2].rows();
+
+	Eigen::MatrixXd A(num_rows, dim + 1);
+	A << As_[r1], As_[r1].rowwise().norm(),
+			 As_[r2], As_[r2].rowwise().norm();
+	Eigen::VectorXd b(num_rows);
+	b << bs_[r1], bs_[r2];
+	b.array() -= margin_;
+
+	drake::solvers::MathematicalProgram prog;
+	auto x = prog.NewContinuousVariables(dim + 1, "x");
+	prog.AddLinearConstraint(
+			A, Eigen::VectorXd::Constant(num_rows, -std::numeric_limits<double>::infinity()),
+			b, x
+			);
+	// Upper bound keeps the LP bounded for unbounded regions
+	prog.AddBoundingBoxConstraint(0, 10, x(dim));
+	prog.AddLinearCost(-x(dim));
+
+	auto result = drake::solvers::Solve(prog);
+	if (!result.is_success()) return false;
+
+	*point = result.GetSolution(x).head(dim);
+	return true;
+}
+
+bool RegionGraph::are_neighbours(int r1, int r2) const
+{
+	const auto& n = neighbours_[r1];
+	return std::find(n.begin(), n.end(), r2) != n.end();
+}
+
+const std::vector<int>& RegionGraph::get_neighbours(int r) const
+{
+	return neighbours_[r];
+}
+
+const Eigen::VectorXd& RegionGraph::get_transition_point(int r1, int r2) const
+{
+	const auto& n = neighbours_[r1];
+	const int k = std::find(n.begin(), n.end(), r2) - n.begin();
+	assert(k < (int) n.size());
+	return transition_points_[r1][k];
+}
+
+std::vector<int> RegionGraph::get_regions_containing(const Eigen::VectorXd& point) const
+{
+	std::vector<int> regions;
+	for (int r = 0; r < num_regions_; ++r)
+		if (((As_[r] * point).array() <= bs_[r].array() - margin_).all())
+			regions.push_back(r);
+
+	return regions;
+}
+
+// Breadth first search, as all transitions have the same cost
+std::vector<int> RegionGraph::get_distances(const std::vector<int>& sources) const
+{
+	std::vector<int> dist(num_regions_, -1);
+	std::queue<int> queue;
+	for (int r : sources)
+	{
+		dist[r] = 0;
+		queue.push(r);
+	}
+
+	while (!queue.empty())
+	{
+		int r = queue.front();
+		queue.pop();
+		for (int n : neighbours_[r])
+			if (dist[n] == -1)
+			{
+				dist[n] = dist[r] + 1;
+				queue.push(n);
+			}
+	}
+
+	return dist;
+}
+
+// The search states are a region together with the point it was entered at,
+// i.e. the previous region or the start point. Moving from a state to a
+// neighbour costs the distance to the transition point, and the straight line
+// distance to the goal is used as the (consistent) heuristic.
+bool RegionGraph::find_shortest_path(
+		const Eigen::VectorXd& start,
+		const Eigen::VectorXd& goal,
+		RegionPath* path
+		) const
+{
+	auto start_regions = get_regions_containing(start);
+	auto goal_regions = get_regions_containing(goal);
+	if (start_regions.empty() || goal_regions.empty()) return false;
+
+	std::vector<bool> is_goal_region(num_regions_, false);
+	for (int r : goal_regions) is_goal_region[r] = true;
+
+	// State r * (num_regions + 1) + prev, with prev = num_regions for the start point
+	const int num_prev = num_regions_ + 1;
+	const int goal_state = num_regions_ * num_prev;
+	auto entry_point = [&](int state) -> const Eigen::VectorXd&
+	{
+		const int r = state / num_prev;
+		const int prev = state % num_prev;
+		return prev == num_regions_ ? start : get_transition_point(prev, r);
+	};
+
+	std::vector<double> cost(goal_state + 1, std::numeric_limits<double>::infinity());
+	std::vector<int> parent(goal_state + 1, -1);
+	std::vector<bool> closed(goal_state + 1, false);
+	typedef std::pair<double, int> queue_entry_t;
+	std::priority_queue<
+		queue_entry_t, std::vector<queue_entry_t>, std::greater<queue_entry_t>
+		> queue;
+
+	auto relax = [&](int state, int from, double new_cost, const Eigen::VectorXd& point)
+	{
+		if (new_cost >= cost[state]) return;
+		cost[state] = new_cost;
+		parent[state] = from;
+		queue.push({ new_cost + (goal - point).norm(), state });
+	};
+
+	for (int r : start_regions)
+		relax(r * num_prev + num_regions_, -1, 0.0, start);
+
+	while (!queue.empty())
+	{
+		const int state = queue.top().second;
+		queue.pop();
+		if (state == goal_state) break;
+		if (closed[state]) continue;
+		closed[state] = true;
+
+		const int r = state / num_prev;
+		const Eigen::VectorXd& point = entry_point(state);
+		if (is_goal_region[r])
+			relax(goal_state, state, cost[state] + (goal - point).norm(), goal);
+		for (int k = 0; k < (int) neighbours_[r].size(); ++k)
+		{
+			const Eigen::VectorXd& next_point = transition_points_[r][k];
+			relax(
+					neighbours_[r][k] * num_prev + r, state,
+					cost[state] + (next_point - point).norm(), next_point
+					);
+		}
+	}
+
+	if (parent[goal_state] == -1) return false;
+
+	path->regions.clear();
+	path->points = { goal };
+	for (int state = parent[goal_state]; state != -1; state = parent[state])
+	{
+		path->regions.push_back(state / num_prev);
+		path->points.push_back(entry_point(state));
+	}
+	std::reverse(path->regions.begin(), path->regions.end());
+	std::reverse(path->points.begin(), path->points.end());
+	path->length = cost[goal_state];
+
+	return true;
+}
+
+// Dynamic programming over the segments, where score(r,j) is the largest total
+// weight of the segments 0, ..., j with segment j in region r
+Eigen::MatrixX<int> RegionGraph::round_region_weights(
+		const Eigen::MatrixXd& weights,
+		const Eigen::VectorXd& start,
+		const Eigen::VectorXd& goal
+		) const
+{
+	assert(weights.rows() == num_regions_);
+	const int num_traj_segments = weights.cols();
+	auto start_regions = get_regions_containing(start);
+	auto goal_regions = get_regions_containing(goal);
+
+	const double inf = std::numeric_limits<double>::infinity();
+	Eigen::MatrixXd score = Eigen::MatrixXd::Constant(num_regions_, num_traj_segments, -inf);
+	Eigen::MatrixX<int> prev = Eigen::MatrixX<int>::Constant(num_regions_, num_traj_segments, -1);
+	for (int r : start_regions)
+		score(r,0) = weights(r,0);
+
+	for (int j = 1; j < num_traj_segments; ++j)
+		for (int r = 0; r < num_regions_; ++r)
+		{
+			auto relax = [&](int p)
+			{
+				if (score(p, j - 1) + weights(r,j) > score(r,j))
+				{
+					score(r,j) = score(p, j - 1) + weights(r,j);
+					prev(r,j) = p;
+				}
+			};
+			relax(r);
+			for (int n : neighbours_[r])
+				relax(n);
+		}
+
+	int r = -1;
+	for (int g : goal_regions)
+		if (score(g, num_traj_segments - 1) > -inf
+				&& (r == -1 || score(g, num_traj_segments - 1) > score(r, num_traj_segments - 1)))
+			r = g;
+	if (r == -1) return Eigen::MatrixX<int>();
+
+	Eigen::MatrixX<int> assignments =
+		Eigen::MatrixX<int>::Zero(num_regions_, num_traj_segments);
+	for (int j = num_traj_segments - 1; j >= 0; --j)
+	{
+		assignments(r,j) = 1;
+		r = prev(r,j);
+	}
+
+	return assignments;
+}
+
+Eigen::MatrixX<int> get_region_assignments_along_path(
+		const RegionPath& path, int num_regions, int num_traj_segments
+		)
+{
+	const int path_size = path.regions.size();
+	if (path_size > num_traj_segments) return Eigen::MatrixX<int>();
+
+	std::vector<double> lengths(path_size);
+	for (int k = 0; k < path_size; ++k)
+		lengths[k] = (path.points[k + 1] - path.points[k]).norm();
+
+	// Give each remaining segment to the region with the longest
+	// path length per segment
+	std::vector<int> num_segments(path_size, 1);
+	for (int s = path_size; s < num_traj_segments; ++s)
+	{
+		int longest = 0;
+		for (int k = 1; k < path_size; ++k)
+			if (lengths[k] / num_segments[k] > lengths[longest] / num_segments[longest])
+				longest = k;
+		++num_segments[longest];
+	}
+
+	Eigen::MatrixX<int> assignments =
+		Eigen::MatrixX<int>::Zero(num_regions, num_traj_segments);
+	int j = 0;
+	for (int k = 0; k < path_size; ++k)
+		for (int s = 0; s < num_segments[k]; ++s)
+			assignments(path.regions[k], j++) = 1;
+
+	return assignments;
+}
+
+} // namespace trajopt
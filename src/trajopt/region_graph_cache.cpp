@@ -0,0 +1,207 @@
+#include "trajopt/region_graph_cache.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trajopt
+{
+
+constexpr char kRegionGraphCacheMagic[8] = "TOREGGR";
+// Increase when the layout or the graph construction changes
+constexpr uint32_t kRegionGraphCacheVersion = 1;
+
+namespace
+{
+	class Fnv1a
+	{
+		public:
+			void add(const void* data, size_t size)
+			{
+				const auto* bytes = static_cast<const unsigned char*>(data);
+				for (size_t i = 0; i < size; ++i)
+				{
+					hash_ ^= bytes[i];
+					hash_ *= 1099511628211ull;
+				}
+			}
+			template <typename T>
+			void add(const T& value) { add(&value, sizeof(T)); }
+			uint64_t get() const { return hash_; }
+
+		private:
+			uint64_t hash_ = 14695981039346656037ull;
+	};
+
+	size_t get_points_offset(int num_edges)
+	{
+		const size_t edges_end = sizeof(RegionGraphCacheHeader) + 2 * num_edges * sizeof(int32_t);
+		return (edges_end + 7) / 8 * 8;
+	}
+} // namespace
+
+uint64_t hash_regions(
+		const std::vector<Eigen::MatrixXd>& As,
+		const std::vector<Eigen::VectorXd>& bs,
+		double margin
+		)
+{
+	Fnv1a hash;
+	hash.add(kRegionGraphCacheVersion);
+	hash.add(margin);
+	hash.add(As.size());
+	for (int r = 0; r < (int) As.size(); ++r)
+	{
+		hash.add(As[r].rows());
+		hash.add(As[r].cols());
+		hash.add(As[r].data(), As[r].size() * sizeof(double));
+		hash.add(bs[r].data(), bs[r].size() * sizeof(double));
+	}
+	return hash.get();
+}
+
+bool read_region_graph(
+		const std::string& path,
+		const std::vector<Eigen::MatrixXd>& As,
+		const std::vector<Eigen::VectorXd>& bs,
+		double margin,
+		std::shared_ptr<const RegionGraph>* region_graph
+		)
+{
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1) return false;
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t) sizeof(RegionGraphCacheHeader))
+	{
+		close(fd);
+		return false;
+	}
+	const size_t size = file_stat.st_size;
+	void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return false;
+
+	const auto* bytes = static_cast<const char*>(data);
+	const auto* header = reinterpret_cast<const RegionGraphCacheHeader*>(bytes);
+	const int dim = As.empty() ? 0 : As[0].cols();
+	bool valid = std::memcmp(header->magic, kRegionGraphCacheMagic, 8) == 0
+		&& header->version == kRegionGraphCacheVersion
+		&& header->key == hash_regions(As, bs, margin)
+		&& header->num_regions == (int) As.size()
+		&& (int) header->dim == dim
+		&& header->num_edges >= 0
+		&& size == get_points_offset(header->num_edges)
+			+ dim * header->num_edges * sizeof(double);
+
+	if (valid)
+	{
+		const auto* edge_data = reinterpret_cast<const int32_t*>(
+				bytes + sizeof(RegionGraphCacheHeader)
+				);
+		const auto* point_data = reinterpret_cast<const double*>(
+				bytes + get_points_offset(header->num_edges)
+				);
+
+		std::vector<std::pair<int, int>> edges(header->num_edges);
+		std::vector<Eigen::VectorXd> points(header->num_edges);
+		for (int k = 0; k < header->num_edges; ++k)
+		{
+			edges[k] = { edge_data[2 * k], edge_data[2 * k + 1] };
+			valid = valid && edges[k].first >= 0 && edges[k].first < edges[k].second
+				&& edges[k].second < header->num_regions;
+			points[k] = Eigen::Map<const Eigen::VectorXd>(point_data + k * dim, dim);
+		}
+		if (valid)
+			*region_graph = std::make_shared<const RegionGraph>(
+					As, bs, margin, edges, points
+					);
+	}
+
+	munmap(data, size);
+	return valid;
+}
+
+bool write_region_graph(
+		const std::string& path,
+		uint64_t key,
+		const RegionGraph& region_graph
+		)
+{
+	std::vector<int32_t> edge_data;
+	std::vector<double> point_data;
+	const int dim = region_graph.get_dim();
+	for (int r1 = 0; r1 < region_graph.get_num_regions(); ++r1)
+		for (int r2 : region_graph.get_neighbours(r1))
+		{
+			if (r2 < r1) continue;
+
+			const Eigen::VectorXd& point = region_graph.get_transition_point(r1, r2);
+			assert(point.size() == dim);
+			edge_data.push_back(r1);
+			edge_data.push_back(r2);
+			point_data.insert(point_data.end(), point.data(), point.data() + dim);
+		}
+
+	RegionGraphCacheHeader header;
+	std::memcpy(header.magic, kRegionGraphCacheMagic, 8);
+	header.version = kRegionGraphCacheVersion;
+	header.dim = dim;
+	header.key = key;
+	header.num_regions = region_graph.get_num_regions();
+	header.num_edges = edge_data.size() / 2;
+
+	const std::string tmp_path = path + ".tmp" + std::to_string(getpid());
+	{
+		std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!file) return false;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(
+				reinterpret_cast<const char*>(edge_data.data()),
+				edge_data.size() * sizeof(int32_t)
+				);
+		const size_t padding = get_points_offset(header.num_edges)
+			- sizeof(header) - edge_data.size() * sizeof(int32_t);
+		const char zeros[8] = {};
+		file.write(zeros, padding);
+		file.write(
+				reinterpret_cast<const char*>(point_data.data()),
+				point_data.size() * sizeof(double)
+				);
+		if (!file) return false;
+	}
+
+	return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+std::shared_ptr<const RegionGraph> load_or_build_region_graph(
+		const std::vector<Eigen::MatrixXd>& As,
+		const std::vector<Eigen::VectorXd>& bs,
+		double margin,
+		const std::string& cache_dir
+		)
+{
+	if (cache_dir.empty())
+		return std::make_shared<const RegionGraph>(As, bs, margin);
+
+	const uint64_t key = hash_regions(As, bs, margin);
+	std::stringstream path;
+	path << cache_dir << "/region_graph_" << std::hex << key << ".bin";
+
+	std::shared_ptr<const RegionGraph> region_graph;
+	if (read_region_graph(path.str(), As, bs, margin, &region_graph))
+		return region_graph;
+
+	region_graph = std::make_shared<const RegionGraph>(As, bs, margin);
+	if (!write_region_graph(path.str(), key, *region_graph))
+		std::cout << "Could not write the region graph cache " << path.str() << std::endl;
+	return region_graph;
+}
+
+} // namespace trajopt
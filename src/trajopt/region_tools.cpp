@@ -0,0 +1,133 @@
+#include "trajopt/region_tools.h"
+
+#include <cassert>
+#include <cmath>
+#include <Eigen/LU>
+
+namespace trajopt
+{
+
+// Tolerance for a vertex to be on a halfspace, and for two rows to be equal
+static const double kHalfspaceTolerance = 1e-6;
+
+Eigen::VectorXd calc_tight_big_M(
+		const Eigen::MatrixXd& A,
+		const Eigen::VectorXd& b,
+		const Eigen::VectorXd& lower,
+		const Eigen::VectorXd& upper,
+		double radius
+		)
+{
+	// The maximum of a linear function over a box is attained in the corner
+	// given by the signs of a_i
+	Eigen::VectorXd max_ax =
+		A.cwiseMax(0.0) * upper + A.cwiseMin(0.0) * lower;
+
+	return (max_ax - b).array().cwiseMax(-radius) + radius;
+}
+
+void normalize_halfspaces(Eigen::MatrixXd* A, Eigen::VectorXd* b)
+{
+	for (int i = 0; i < A->rows(); ++i)
+	{
+		double norm = A->row(i).norm();
+		assert(norm > 0);
+		A->row(i) /= norm;
+		(*b)(i) /= norm;
+	}
+}
+
+static Eigen::MatrixXd select_rows(
+		const Eigen::MatrixXd& M, const std::vector<int>& rows
+		)
+{
+	Eigen::MatrixXd selected(rows.size(), M.cols());
+	for (int k = 0; k < (int) rows.size(); ++k)
+		selected.row(k) = M.row(rows[k]);
+	return selected;
+}
+
+std::vector<int> find_nonredundant_halfspaces(
+		const Eigen::MatrixXd& A,
+		const Eigen::VectorXd& b,
+		const std::vector<Eigen::VectorXd>& vertices
+		)
+{
+	const int dim = A.cols();
+	std::vector<int> facets;
+	for (int i = 0; i < A.rows(); ++i)
+	{
+		bool is_duplicate = false;
+		for (int k : facets)
+			if ((A.row(i) - A.row(k)).norm() < kHalfspaceTolerance
+					&& std::abs(b(i) - b(k)) < kHalfspaceTolerance)
+				is_duplicate = true;
+		if (is_duplicate) continue;
+
+		// The halfspace is a facet if the vertices on it span dim - 1 dimensions
+		std::vector<Eigen::VectorXd> tight;
+		for (const auto& v : vertices)
+			if (std::abs(A.row(i).dot(v) - b(i)) < kHalfspaceTolerance)
+				tight.push_back(v);
+		if ((int) tight.size() < dim) continue;
+
+		Eigen::MatrixXd span(dim, tight.size() - 1);
+		for (int k = 1; k < (int) tight.size(); ++k)
+			span.col(k - 1) = tight[k] - tight[0];
+		Eigen::FullPivLU<Eigen::MatrixXd> lu(span);
+		lu.setThreshold(kHalfspaceTolerance);
+		if (lu.rank() == dim - 1)
+			facets.push_back(i);
+	}
+	return facets;
+}
+
+void remove_redundant_halfspaces(
+		const std::vector<Eigen::VectorXd>& vertices,
+		Eigen::MatrixXd* A, Eigen::VectorXd* b
+		)
+{
+	normalize_halfspaces(A, b);
+	std::vector<int> facets = find_nonredundant_halfspaces(*A, *b, vertices);
+	*A = select_rows(*A, facets);
+	*b = select_rows(*b, facets);
+}
+
+void get_box_halfspaces(
+		const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+		Eigen::MatrixXd* A, Eigen::VectorXd* b
+		)
+{
+	const int dim = lower.size();
+	A->resize(2 * dim, dim);
+	*A << -Eigen::MatrixXd::Identity(dim, dim),
+				Eigen::MatrixXd::Identity(dim, dim);
+	b->resize(2 * dim);
+	*b << -lower, upper;
+}
+
+void remove_box_facets(
+		const Eigen::VectorXd& lower, const Eigen::VectorXd& upper,
+		Eigen::MatrixXd* A, Eigen::VectorXd* b
+		)
+{
+	Eigen::MatrixXd A_box;
+	Eigen::VectorXd b_box;
+	get_box_halfspaces(lower, upper, &A_box, &b_box);
+
+	std::vector<int> kept;
+	for (int i = 0; i < A->rows(); ++i)
+	{
+		bool is_box_facet = false;
+		for (int k = 0; k < A_box.rows(); ++k)
+			if ((A->row(i) - A_box.row(k)).norm() < kHalfspaceTolerance
+					&& std::abs((*b)(i) - b_box(k)) < kHalfspaceTolerance)
+				is_box_facet = true;
+		if (!is_box_facet)
+			kept.push_back(i);
+	}
+	*A = select_rows(*A, kept);
+	*b = select_rows(*b, kept);
+}
+
+} // namespace trajopt
@@ -62,6 +62,19 @@ void SafeRegions::set_bounds(
 	iris_problem_.setBounds(bounds);
 }
 
+Eigen::VectorXd SafeRegions::get_bounds_lower()
+{
+	if (num_dimensions_ == 2)
+		return Eigen::Vector2d(x_min_, y_min_);
+	return Eigen::Vector3d(x_min_, y_min_, z_min_);
+}
+
+Eigen::VectorXd SafeRegions::get_bounds_upper()
+{
+	if (num_dimensions_ == 2)
+		return Eigen::Vector2d(x_max_, y_max_);
+	return Eigen::Vector3d(x_max_, y_max_, z_max_);
+}
 
 void SafeRegions::set_obstacles(std::vector<Eigen::Matrix3Xd> obstacles)
 {
@@ -115,7 +128,7 @@ void SafeRegions::calc_safe_regions_from_seedpoints(std::vector<Eigen::Vector3d>
 		safe_regions_.push_back(region.getPolyhedron());
 	}
 
-	for (int i = 0; i < safe_regions_.size(); ++i)
+	for (int i = 0; i < (int) safe_regions_.size(); ++i)
 	{
 		safe_region_As_.push_back(safe_regions_[i].getA());
 		safe_region_bs_.push_back(safe_regions_[i].getB());
@@ -131,6 +144,22 @@ void SafeRegions::calc_safe_regions_auto(int num_seeds)
 		calc_safe_region(find_best_point());
 }
 
+void SafeRegions::remove_redundant_halfspaces()
+{
+	int num_before = 0;
+	int num_after = 0;
+	for (int r = 0; r < (int) safe_regions_.size(); ++r)
+	{
+		num_before += safe_region_As_[r].rows();
+		trajopt::remove_redundant_halfspaces(
+				safe_regions_[r].generatorPoints(), &safe_region_As_[r], &safe_region_bs_[r]
+				);
+		num_after += safe_region_As_[r].rows();
+	}
+
+	std::cout << "Region halfspaces: " << num_before << " -> " << num_after << std::endl;
+}
+
 // *********
 // Private helper functions
 // *********
@@ -207,8 +236,8 @@ double SafeRegions::calc_min_dist(Eigen::Vector3d point)
 	{
 		std::vector<Eigen::VectorXd> vertices = region.generatorPoints();
 
-		for (int i = 0; i < vertices.size(); ++i)
-			for (int j = 0; j < vertices.size(); ++j)
+		for (int i = 0; i < (int) vertices.size(); ++i)
+			for (int j = 0; j < (int) vertices.size(); ++j)
 			{
 				// Don't check same point
 				if (i == j) continue;
@@ -228,7 +257,7 @@ double SafeRegions::calc_min_dist(Eigen::Vector3d point)
 bool SafeRegions::is_collision(Eigen::Vector3d point)
 {
 	// Check collision with regions given as half spaces
-	for (int i = 0; i < safe_region_As_.size(); ++i)
+	for (int i = 0; i < (int) safe_region_As_.size(); ++i)
 	{
 		auto A = safe_region_As_[i];
 		auto b = safe_region_bs_[i];
@@ -240,7 +269,7 @@ bool SafeRegions::is_collision(Eigen::Vector3d point)
 	}
 
 	// Check collision with obstacles given as half spaces
-	for (int i = 0; i < obstacles_As_.size(); ++i)
+	for (int i = 0; i < (int) obstacles_As_.size(); ++i)
 	{
 		auto A = obstacles_As_[i];
 		auto b = obstacles_bs_[i];
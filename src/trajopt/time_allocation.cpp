@@ -0,0 +1,104 @@
+#include "trajopt/time_allocation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace trajopt
+{
+
+double calc_min_time_scaling(
+		const SolvedTrajectory& traj,
+		const DynamicLimits& limits,
+		int samples_per_segment
+		)
+{
+	const int num_vars = traj.get_num_vars();
+	Eigen::VectorXd g = Eigen::VectorXd::Zero(num_vars);
+	if (num_vars == 3) g(2) = limits.gravity;
+	assert(limits.max_thrust_acceleration > g.norm());
+
+	const int num_samples = samples_per_segment * traj.get_num_segments() + 1;
+	TrajectorySamples samples(num_vars, 2, num_samples);
+	traj.eval_batch(
+			Eigen::VectorXd::LinSpaced(num_samples, traj.get_start_time(), traj.get_end_time()),
+			&samples
+			);
+
+	double alpha = 0;
+	for (int s = 0; s < num_samples; ++s)
+	{
+		const Eigen::VectorXd v = samples.get_sample(1, s);
+		const Eigen::VectorXd a = samples.get_sample(2, s);
+		alpha = std::max(alpha, v.norm() / limits.max_velocity);
+
+		// With u = 1 / alpha^2: || u * a + g || <= max_thrust_acceleration,
+		// which holds for u between zero and the larger root of
+		// |a|^2 u^2 + 2 a^T g u + |g|^2 - max_thrust_acceleration^2
+		const double a_sq = a.squaredNorm();
+		if (a_sq < 1e-12) continue;
+		const double ag = a.dot(g);
+		const double c = g.squaredNorm() - std::pow(limits.max_thrust_acceleration, 2);
+		const double u_max = (-ag + std::sqrt(ag * ag - a_sq * c)) / a_sq;
+		alpha = std::max(alpha, 1.0 / std::sqrt(u_max));
+	}
+
+	// A trajectory at rest satisfies the limits at any speed
+	return alpha > 0 ? alpha : 1.0;
+}
+
+SolvedTrajectory scale_time(const SolvedTrajectory& traj, double alpha)
+{
+	assert(alpha > 0);
+
+	std::vector<Eigen::MatrixXd> coeffs;
+	std::vector<double> breaks;
+	for (int j = 0; j < traj.get_num_segments(); ++j)
+	{
+		Eigen::MatrixXd c = traj.get_segment_coeffs(j);
+		for (int n = 0; n < c.cols(); ++n)
+			c.col(n) /= std::pow(alpha, n);
+		coeffs.push_back(c);
+	}
+	for (double t : traj.get_breaks())
+		breaks.push_back(alpha * t);
+
+	return SolvedTrajectory(coeffs, breaks);
+}
+
+double golden_section_search(
+		const std::function<double(double)>& f,
+		double lower, double upper, int num_iterations
+		)
+{
+	const double inv_phi = (std::sqrt(5.0) - 1) / 2;
+
+	double x1 = upper - inv_phi * (upper - lower);
+	double x2 = lower + inv_phi * (upper - lower);
+	double f1 = f(x1);
+	double f2 = f(x2);
+	for (int k = 0; k < num_iterations; ++k)
+	{
+		if (f1 < f2)
+		{
+			upper = x2;
+			x2 = x1;
+			f2 = f1;
+			x1 = upper - inv_phi * (upper - lower);
+			f1 = f(x1);
+		}
+		else
+		{
+			lower = x1;
+			x1 = x2;
+			f1 = f2;
+			x2 = lower + inv_phi * (upper - lower);
+			f2 = f(x2);
+		}
+	}
+
+	return f1 < f2 ? x1 : x2;
+}
+
+} // namespace trajopt